@@ -17,6 +17,7 @@
 #include <tui++/Dimension.h>
 #include <tui++/Rectangle.h>
 #include <tui++/ActionMap.h>
+#include <tui++/RepaintManager.h>
 #include <tui++/KeyStroke.h>
 #include <tui++/Constraints.h>
 #include <tui++/ComponentInputMap.h>
@@ -46,8 +47,8 @@ template<typename T>
 constexpr bool is_component_v = std::is_base_of_v<Component, T>;
 
 class Component: public Object, public std::enable_shared_from_this<Component>, public EventSource<ComponentEvent, ContainerEvent, FocusEvent, HierarchyEvent, HierarchyBoundsEvent, KeyEvent,
-    MousePressEvent, MouseClickEvent, MouseMoveEvent, MouseOverEvent, MouseWheelEvent> {
-  using base = EventSource<ComponentEvent, ContainerEvent, FocusEvent, HierarchyEvent, HierarchyBoundsEvent, KeyEvent, MousePressEvent, MouseClickEvent, MouseMoveEvent, MouseOverEvent, MouseWheelEvent>;
+    PasteEvent, MousePressEvent, MouseClickEvent, MouseMoveEvent, MouseOverEvent, MouseWheelEvent> {
+  using base = EventSource<ComponentEvent, ContainerEvent, FocusEvent, HierarchyEvent, HierarchyBoundsEvent, KeyEvent, PasteEvent, MousePressEvent, MouseClickEvent, MouseMoveEvent, MouseOverEvent, MouseWheelEvent>;
 
 protected:
   static std::recursive_mutex tree_mutex;
@@ -81,6 +82,15 @@ protected:
   mutable Property<std::optional<Dimension>> maximum_size { this, "MaximumSize" };
   mutable Property<std::optional<Dimension>> preferred_size { this, "PreferredSize" };
 
+  /**
+   * Tells windows and frames from other components without a dynamic_cast, Window and Frame set it when constructed.
+   */
+  enum Kind : unsigned char {
+    COMPONENT_KIND = 0,
+    WINDOW_KIND = 1 << 0,
+    FRAME_KIND = WINDOW_KIND | 1 << 1
+  } kind = COMPONENT_KIND;
+
   struct {
     unsigned is_valid :1;
     unsigned is_focus_traversable_overridden :1;
@@ -226,8 +236,6 @@ protected:
   friend auto make_component(Args&&...);
 
 protected:
-  static bool is_window(const std::shared_ptr<const Component> &component);
-
   constexpr static auto npos = std::numeric_limits<size_t>::max();
 
   size_t get_component_index(const Component *component) const {
@@ -375,6 +383,7 @@ protected:
   void register_with_keyboard_manager(bool only_if_new);
 
   friend class Window;
+  friend class RepaintManager;
   friend class KeyboardManager;
   friend class KeyboardFocusManager;
   friend class laf::LookAndFeel;
@@ -516,13 +525,25 @@ public:
   template<typename T, std::enable_if_t<std::derived_from<T, Component>, bool> = true>
   std::shared_ptr<T> get_parent() const {
     for (auto parent = get_parent(); parent; parent = parent->get_parent()) {
-      if (auto candidate = std::dynamic_pointer_cast<T>(parent)) {
+      if constexpr (std::same_as<T, Window>) {
+        if (is_window(parent)) {
+          return std::static_pointer_cast<T>(parent);
+        }
+      } else if (auto candidate = std::dynamic_pointer_cast<T>(parent)) {
         return candidate;
       }
     }
     return {};
   }
 
+  static bool is_window(const std::shared_ptr<const Component> &component) {
+    return component and component->kind & WINDOW_KIND;
+  }
+
+  static bool is_frame(const std::shared_ptr<const Component> &component) {
+    return component and component->kind == FRAME_KIND;
+  }
+
   int get_x() const {
     return this->location.x;
   }
@@ -644,7 +665,7 @@ public:
    * Causes this component to be repainted as soon as possible (this is done by posting a RepaintEvent onto the system queue).
    */
   void repaint() {
-    repaint(get_x(), get_y(), get_width(), get_height());
+    repaint(0, 0, get_width(), get_height());
   }
 
   /**
@@ -693,9 +714,7 @@ public:
       parent->repaint(px, py, pwidth, pheight);
     } else {
       if (is_visible() and width > 0 and height > 0) {
-        // TODO
-//        PaintEvent e = new PaintEvent(this, new Rectangle(x, y, width, height));
-//        Toolkit.getDefaultToolkit().getSystemEventQueue().postEvent(e);
+        RepaintManager::single->add_dirty_region(shared_from_this(), x, y, width, height);
       }
     }
   }
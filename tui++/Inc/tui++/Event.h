@@ -1,9 +1,12 @@
 #pragma once
 
+#include <cassert>
+
 #include <tui++/event/KeyEvent.h>
 #include <tui++/event/ItemEvent.h>
 #include <tui++/event/FocusEvent.h>
 #include <tui++/event/MouseEvent.h>
+#include <tui++/event/PasteEvent.h>
 #include <tui++/event/ActionEvent.h>
 #include <tui++/event/ChangeEvent.h>
 #include <tui++/event/WindowEvent.h>
@@ -95,6 +98,11 @@ struct event_type<MouseWheelEvent> {
   constexpr static EventType value = EventType::MOUSE_WHEEL;
 };
 
+template<>
+struct event_type<PasteEvent> {
+  constexpr static EventType value = EventType::PASTE;
+};
+
 template<>
 struct event_type<WindowEvent> {
   constexpr static EventType value = EventType::WINDOW;
@@ -109,6 +117,9 @@ constexpr EventTypeMask event_mask_v = (event_type_v<Event> | ... | event_type_v
 constexpr EventTypeMask MOUSE_EVENT_MASK = EventType::MOUSE_PRESS | EventType::MOUSE_CLICK | EventType::MOUSE_DRAG | EventType::MOUSE_MOVE | EventType::MOUSE_OVER | EventType::MOUSE_WHEEL;
 constexpr EventTypeMask KEY_EVENT_MASK = EventType::KEY;
 constexpr EventTypeMask WINDOW_EVENT_MASK = EventType::WINDOW;
+// The events whose source, if any, is always a Component, the rest may come from models and other objects.
+constexpr EventTypeMask COMPONENT_SOURCE_EVENT_MASK = MOUSE_EVENT_MASK | KEY_EVENT_MASK | WINDOW_EVENT_MASK | EventType::FOCUS | EventType::PASTE
+    | EventType::COMPONENT | EventType::CONTAINER | EventType::HIERARCHY | EventType::HIERARCHY_BOUNDS;
 
 template<typename E>
 struct is_mouse_event {
@@ -118,6 +129,27 @@ struct is_mouse_event {
 template<typename E>
 constexpr bool is_mouse_event_v = is_mouse_event<E>::value;
 
+/**
+ * dynamic_cast of an event told by its id rather than by RTTI.
+ *
+ * An event class that reuses the type of another has to derive from it, which the debug build checks.
+ *
+ * @return the event as E if its type is that of E, nullptr otherwise
+ */
+template<typename E>
+constexpr E* event_cast(Event &e) {
+  if (e.id.type != event_type_v<E>) {
+    return nullptr;
+  }
+  assert(dynamic_cast<E*>(&e) != nullptr);
+  return static_cast<E*>(&e);
+}
+
+template<typename E>
+std::shared_ptr<E> event_cast(std::shared_ptr<Event> const &e) {
+  return e and event_cast<E>(*e) ? std::static_pointer_cast<E>(e) : nullptr;
+}
+
 std::ostream& operator<<(std::ostream &os, const Event &event);
 
 template<>
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <list>
+#include <array>
 #include <mutex>
+#include <atomic>
 #include <chrono>
 #include <memory>
+#include <functional>
 #include <condition_variable>
 
 #include <tui++/Event.h>
@@ -12,17 +15,43 @@ namespace tui {
 
 class Component;
 
+/**
+ * Multi-producer/single-consumer event queue.
+ *
+ * Events are passed through a lock-free bounded ring (Vyukov's bounded queue with a single consumer). Should the ring get full,
+ * producers fall back to a mutex protected overflow list until the consumer drains it, so no event is ever dropped and the order of
+ * events posted by one thread is preserved. Producers only touch the condition variable when the consumer is parked waiting for
+ * events, either in pop() or externally between park() and unpark().
+ */
 class EventQueue {
-  mutable std::mutex mutex;
-  std::list<std::shared_ptr<Event>> queue;
+  constexpr static size_t RING_SIZE = 1024;
+  constexpr static size_t RING_MASK = RING_SIZE - 1;
+  static_assert((RING_SIZE & RING_MASK) == 0, "ring size must be a power of two");
+
+  struct Cell {
+    std::atomic<size_t> sequence;
+    std::shared_ptr<Event> event;
+  };
+
+  std::array<Cell, RING_SIZE> ring;
+  alignas(64) std::atomic<size_t> write_pos = 0;
+  alignas(64) std::atomic<size_t> read_pos = 0;
+
+  mutable std::mutex overflow_mutex;
+  std::list<std::shared_ptr<Event>> overflow;
+  std::atomic<size_t> overflow_size = 0;
+
+  std::mutex park_mutex;
   std::condition_variable queue_cv;
+  std::atomic<bool> consumer_parked = false;
+  std::function<void()> wakeup_handler;
 
   std::atomic<std::weak_ptr<Event>> current_event;
   std::atomic<EventClock::time_point> most_recent_event_time;
   std::atomic<EventClock::time_point> most_recent_key_event_time;
 
 public:
-  EventQueue() = default;
+  EventQueue();
 
   EventQueue(EventQueue const&) = delete;
   EventQueue(EventQueue&&) = delete;
@@ -40,9 +69,26 @@ public:
 
   std::shared_ptr<Event> pop();
   std::shared_ptr<Event> pop(const std::chrono::milliseconds &timeout);
+  std::shared_ptr<Event> try_pop();
+
+  /**
+   * Sets the handler called by producers to wake up a consumer that is parked outside of pop(), e.g. in a poll() on its input.
+   * Must be set before any event is pushed.
+   */
+  void set_wakeup_handler(std::function<void()> handler) {
+    this->wakeup_handler = std::move(handler);
+  }
+
+  /**
+   * Announces that the consumer is going to block outside of pop(). From now on every push calls the wakeup handler.
+   *
+   * @return true iff the queue is still empty, i.e. the consumer may block
+   */
+  bool park();
+  void unpark();
 
   bool empty() const {
-    return this->queue.empty();
+    return this->write_pos.load(std::memory_order_acquire) == this->read_pos.load(std::memory_order_acquire) and this->overflow_size == 0;
   }
 
   std::shared_ptr<Event> get_current_event() const {
@@ -58,6 +104,11 @@ public:
   }
 
 private:
+  bool try_push(const std::shared_ptr<Event> &event);
+  std::shared_ptr<Event> dequeue();
+
+  void wake_consumer();
+
   void set_current_event(std::shared_ptr<Event> const &event);
 };
 
@@ -13,6 +13,7 @@ class Frame: public Window {
   using base = Window;
 
   Frame() {
+    this->kind = FRAME_KIND;
   }
 
   template<typename T, typename ... Args>
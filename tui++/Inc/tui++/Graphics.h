@@ -23,6 +23,13 @@ public:
     return create(rect.x, rect.y, rect.width, rect.height);
   }
 
+  /**
+   * Saves the translation, clip, colors, font and stroke, for the matching restore() to bring them back. Unlike create(),
+   * it does not allocate a new Graphics.
+   */
+  virtual void save() = 0;
+  virtual void restore() = 0;
+
   virtual void clip_rect(int x, int y, int width, int height) = 0;
   void clip_rect(Rectangle const &rect) {
     clip_rect(rect.x, rect.y, rect.width, rect.height);
@@ -8,6 +8,7 @@
 
 namespace tui {
 
+class Window;
 class Component;
 
 class RepaintManager: public std::enable_shared_from_this<RepaintManager> {
@@ -28,6 +29,7 @@ public:
 
 private:
   bool extend_dirty_region(std::shared_ptr<Component> const &c, Rectangle const &bounds);
+  static std::shared_ptr<Window> to_window_region(std::shared_ptr<Component> const &c, Rectangle &region);
   void repaint_dirty_regions();
 };
 
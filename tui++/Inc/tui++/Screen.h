@@ -4,6 +4,8 @@
 #include <tui++/Rectangle.h>
 #include <tui++/EventQueue.h>
 
+#include <tui++/util/BlockPool.h>
+
 #include <list>
 #include <mutex>
 
@@ -48,6 +50,7 @@ private:
   void focus(const std::shared_ptr<Window> &gained, const std::shared_ptr<Window> &lost);
 
   friend class Window;
+  friend class RepaintManager;
 
 protected:
   Screen() = default;
@@ -64,7 +67,7 @@ protected:
 
   template<typename T, typename Component, typename ... Args>
   void post_system(const std::shared_ptr<Component> &source, Args &&... args) {
-    post_system(std::make_shared<T>(source, std::forward<Args>(args)...));
+    post_system(util::make_pooled<T>(source, std::forward<Args>(args)...));
   }
 
   void paint(Graphics &g);
@@ -105,11 +108,11 @@ public:
 
   template<typename T, typename Component, typename ... Args>
   void post(const std::shared_ptr<Component> &source, Args &&... args) {
-    post(std::make_shared<T>(source, std::forward<Args>(args)...));
+    post(util::make_pooled<T>(source, std::forward<Args>(args)...));
   }
 
   void post(std::function<void()> fn) {
-    post(std::make_shared<InvocationEvent>(fn));
+    post(util::make_pooled<InvocationEvent>(std::move(fn)));
   }
 
   std::shared_ptr<Window> get_window_at(int x, int y) const;
@@ -118,6 +121,11 @@ public:
   }
 
   virtual void refresh() = 0;
+  virtual void flush() = 0;
+  /**
+   * Prints the pending changes right away, bypassing the frame rate limit, e.g. to echo input with no delay.
+   */
+  virtual void flush_immediately() = 0;
 
   void add_listener(const EventTypeMask &event_mask, const std::shared_ptr<EventListener<Event>> &listener);
   void remove_listener(const std::shared_ptr<EventListener<Event>> &listener);
@@ -43,10 +43,12 @@ protected:
 protected:
   Window(WindowType type = WindowType::NORMAL) :
       type(type) {
+    this->kind = WINDOW_KIND;
   }
 
   Window(const std::shared_ptr<Window> &owner, WindowType type = WindowType::NORMAL) :
       owner(owner), type(type) {
+    this->kind = WINDOW_KIND;
   }
 
   virtual ~Window() {
@@ -185,7 +187,7 @@ constexpr WindowEvent::WindowEvent(const std::shared_ptr<Window> &source, Type t
 }
 
 constexpr std::shared_ptr<Window> WindowEvent::get_window() const {
-  return std::dynamic_pointer_cast<Window>(this->source);
+  return std::static_pointer_cast<Window>(this->source);
 }
 
 }
@@ -63,6 +63,10 @@ public:
     }
   }
 
+  static void dispatch_event(const std::shared_ptr<EventListener<PasteEvent>> &listener, PasteEvent &e) {
+    listener->text_pasted(e);
+  }
+
   static void dispatch_event(const std::shared_ptr<EventListener<ItemEvent>> &listener, ItemEvent &e) {
     listener->item_state_changed(e);
   }
@@ -133,6 +137,8 @@ public:
       dispatch_event(listener, e);
     } else if constexpr (std::is_same_v<MouseOverEvent, Event>) {
       dispatch_event(listener, e);
+    } else if constexpr (std::is_same_v<PasteEvent, Event>) {
+      dispatch_event(listener, e);
     } else if constexpr (std::is_same_v<ItemEvent, Event>) {
       dispatch_event(listener, e);
     } else if constexpr (std::is_same_v<FocusEvent, Event>) {
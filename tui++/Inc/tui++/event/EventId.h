@@ -23,6 +23,7 @@ enum class EventType : unsigned {
   HIERARCHY = CONTAINER << 1,
   HIERARCHY_BOUNDS = HIERARCHY << 1,
   INVOCATION = HIERARCHY_BOUNDS << 1,
+  PASTE = INVOCATION << 1,
 };
 
 using EventTypeMask = util::EnumFlags<EventType>;
@@ -23,6 +23,7 @@ class MouseOverEvent;
 class MouseClickEvent;
 class MousePressEvent;
 class MouseWheelEvent;
+class PasteEvent;
 class WindowEvent;
 
 template<typename MouseEvent>
@@ -99,6 +100,12 @@ public:
   virtual void mouse_wheel_moved(MouseWheelEvent &e) = 0;
 };
 
+template<>
+class EventListener<PasteEvent> : public BasicEventListener<PasteEvent> {
+public:
+  virtual void text_pasted(PasteEvent &e) = 0;
+};
+
 template<>
 class EventListener<FocusEvent> : public BasicEventListener<FocusEvent> {
 public:
@@ -321,8 +321,8 @@ class MultipleEventSource: virtual public MultipleEventSourceBase, virtual prote
 
   template<typename E, typename ... Es>
   void invoke_process_event(Event &e) {
-    if (event_type_v<E> == e.id.type) {
-      SingleEventSource<E>::process_event(*dynamic_cast<E*>(&e));
+    if (auto event = event_cast<E>(e)) {
+      SingleEventSource<E>::process_event(*event);
     } else if constexpr (sizeof...(Es)) {
       invoke_process_event<Es...>(e);
     }
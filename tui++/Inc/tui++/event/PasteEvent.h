@@ -0,0 +1,36 @@
+#pragma once
+
+#include <tui++/event/ComponentEvent.h>
+
+#include <string>
+
+namespace tui {
+
+/**
+ * Text pasted into the terminal as a whole, instead of a key event per character.
+ */
+class PasteEvent: public ComponentEvent {
+public:
+  enum Type : unsigned {
+    TEXT_PASTED = event_id_v<EventType::PASTE, 0>
+  };
+
+public:
+  std::string text;
+
+public:
+  PasteEvent(const std::shared_ptr<Component> &source, std::string text, const EventClock::time_point &when = EventClock::now()) :
+      ComponentEvent(source, TEXT_PASTED, when), text(std::move(text)) {
+  }
+
+  constexpr Type type() const {
+    return Type(std::underlying_type_t<Type>(this->id));
+  }
+
+protected:
+  PasteEvent(PasteEvent const&) = default;
+};
+
+using PasteListener = std::function<void(PasteEvent &e)>;
+
+}
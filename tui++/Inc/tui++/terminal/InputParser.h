@@ -0,0 +1,163 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include <tui++/Event.h>
+
+namespace tui {
+
+/**
+ * Terminal input decoder, a table driven state machine after Paul Williams' parser for DEC compatible terminals
+ * (https://vt100.net/emu/dec_ansi_parser), reduced to what terminals send rather than receive.
+ *
+ * It never waits for input: parse() takes whatever chunk has been read, reports every key and mouse event it
+ * completes and keeps a sequence that is cut off by the end of the chunk to be resumed by the next one.
+ */
+class InputParser {
+public:
+  class Listener {
+  public:
+    virtual ~Listener() = default;
+
+    virtual void new_key_event(const Char &c, InputEvent::Modifiers key_modifiers) = 0;
+    virtual void new_key_event(KeyEvent::KeyCode key_code, InputEvent::Modifiers key_modifiers) = 0;
+    virtual void new_mouse_event(MousePressEvent::Type type, MousePressEvent::Button button, InputEvent::Modifiers key_modifiers, int x, int y) = 0;
+    virtual void new_mouse_wheel_event(int wheel_rotation, InputEvent::Modifiers key_modifiers, int x, int y) = 0;
+    virtual void new_paste_event(std::string_view text) = 0;
+  };
+
+  enum class State : std::uint8_t {
+    GROUND,
+    UTF8,
+    ESCAPE,
+    SS3,
+    CSI_ENTRY,
+    CSI_PARAM,
+    CSI_INTERMEDIATE,
+    CSI_IGNORE,
+    // DCS, OSC, SOS, PM and APC strings, nothing a terminal sends in them is input.
+    STRING,
+    STRING_ESCAPE,
+    // Between CSI 200~ and CSI 201~ of bracketed paste mode.
+    PASTE,
+
+    COUNT
+  };
+
+  enum class Action : std::uint8_t {
+    NONE,
+    PRINT,
+    EXECUTE,
+    UTF8_START,
+    UTF8_CONTINUE,
+    CLEAR,
+    ESCAPE_KEY,
+    ESC_DISPATCH,
+    STRING_START,
+    SS3_DISPATCH,
+    PARAM,
+    COLLECT,
+    CSI_DISPATCH
+  };
+
+  struct Transition {
+    Action action;
+    State state;
+  };
+
+private:
+  constexpr static unsigned MAX_PARAMS = 16;
+  constexpr static unsigned MAX_PARAM_VALUE = 0xFFFF;
+
+  Listener &listener;
+
+  State state = State::GROUND;
+
+  char32_t utf8_code = 0;
+  unsigned utf8_bytes_left = 0;
+
+  // The private marker ('<', '=', '>', '?') and the intermediate byte of the CSI sequence being parsed.
+  char csi_marker = 0;
+  char csi_intermediate = 0;
+  std::array<unsigned, MAX_PARAMS> csi_params;
+  unsigned csi_param_count = 0;
+
+  // Strings that are replies to queries still to come, until then ESC P, ESC ] and the like are keys pressed with Alt.
+  unsigned string_replies_expected = 0;
+
+  // How much of the unfinished paste has been searched for its end.
+  size_t paste_scanned = 0;
+
+private:
+  void perform(Action action, char c);
+
+  void execute(char c);
+  void utf8_start(char c);
+  void utf8_continue(char c);
+  void esc_dispatch(char c);
+  void string_start(char c);
+  void ss3_dispatch(char c);
+  void param(char c);
+  void csi_dispatch(char c);
+  void csi_key_dispatch(char c);
+  void mouse_dispatch(bool pressed);
+  size_t paste(std::string_view input);
+
+  InputEvent::Modifiers get_key_modifiers() const;
+
+public:
+  // Past this size an unfinished paste is reported as it is so far, so that its input is not held on to without bound.
+  constexpr static size_t MAX_PASTE_SIZE = 1 << 20;
+
+  InputParser(Listener &listener) :
+      listener(listener) {
+  }
+
+  /**
+   * Reports the events the input completes, any byte boundary may split a sequence between two calls.
+   *
+   * A paste is reported as a whole, up to MAX_PASTE_SIZE, so the input of an unfinished one is left unconsumed and has to be passed again,
+   * followed by what comes next, to the following call.
+   *
+   * @return the number of bytes consumed from the start of input
+   */
+  size_t parse(std::string_view input);
+
+  /**
+   * @return true if the input ended with an ESC that may be the Escape key or the start of a sequence
+   */
+  bool is_escape_pending() const {
+    return this->state == State::ESCAPE;
+  }
+
+  /**
+   * @return true if the input ended inside a paste, that is still to end with CSI 201~
+   */
+  bool is_paste_pending() const {
+    return this->state == State::PASTE;
+  }
+
+  /**
+   * Takes the next DCS, OSC, SOS, PM or APC string for the reply to a query, it is skipped rather than read as the keys
+   * it is made of. The reply to DA1, which terminals send after all the others, clears the expected replies.
+   */
+  void expect_string_reply() {
+    this->string_replies_expected += 1;
+  }
+
+  /**
+   * Gives up on an unfinished sequence once no more of it has arrived in time, a pending ESC is the Escape key and an
+   * unfinished paste ends with the input parse() left unconsumed.
+   *
+   * @return the number of bytes consumed from the start of input
+   */
+  size_t flush(std::string_view input);
+
+  State get_state() const {
+    return this->state;
+  }
+};
+
+}
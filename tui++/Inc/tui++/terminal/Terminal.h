@@ -1,7 +1,10 @@
 #pragma once
 
 #include <chrono>
+#include <vector>
+#include <string_view>
 #include <variant>
+#include <algorithm>
 #include <iostream>
 #include <functional>
 
@@ -9,6 +12,7 @@
 #include <tui++/Cursor.h>
 #include <tui++/Dimension.h>
 
+#include <tui++/terminal/InputParser.h>
 #include <tui++/terminal/TerminalScreen.h>
 
 namespace tui {
@@ -20,7 +24,7 @@ class TerminalImpl;
 class TerminalScreen;
 class TerminalGraphics;
 
-class Terminal {
+class Terminal: InputParser::Listener {
   enum class DECModeOption {
     LINE_WRAP = 7,
     CURSOR = 25,
@@ -38,7 +42,12 @@ class Terminal {
     MOUSE_PIXEL_POSITION_MODE = 1016,
 
     // The alternate buffer is exactly the dimensions of the window, without any scrollback region.
-    USE_ALTERNATE_SCREEN_BUFFER = 1049
+    USE_ALTERNATE_SCREEN_BUFFER = 1049,
+
+    // Pasted text is bracketed by CSI 200~ and CSI 201~.
+    BRACKETED_PASTE = 2004,
+
+    SYNCHRONIZED_OUTPUT = 2026
   };
 
   // Normally xterm makes a special case regarding modifiers (shift, control, etc.)
@@ -98,115 +107,79 @@ class Terminal {
 
   using Option = std::variant<DECModeOption, ModifyKeyboardOption, ModifyCursorKeysOption, ModifyFunctionKeysOption, ModifyOtherKeysOption>;
 
+  // Growable input buffer, the unread bytes are [read_pos, write_pos).
   class InputBuffer {
   protected:
-    constexpr static size_t BUFFER_SIZE = 256;
-    char buffer[BUFFER_SIZE];
+    constexpr static size_t INITIAL_BUFFER_SIZE = 4096;
+    std::vector<char> buffer = std::vector<char>(INITIAL_BUFFER_SIZE);
     size_t read_pos = 0, write_pos = 0;
 
   public:
     void put(char c) {
-      this->buffer[this->write_pos] = c;
-      this->write_pos = (this->write_pos + 1) % BUFFER_SIZE;
-    }
-
-    auto get_available() const {
-      return (this->write_pos - this->read_pos) % BUFFER_SIZE;
-    }
-  };
-
-  class InputReader: public InputBuffer {
-    Terminal &terminal;
-
-  private:
-    bool read_terminal_input(const std::chrono::milliseconds &timeout) {
-      return this->terminal.read_input(timeout, *this);
+      *reserve(1) = c;
+      commit(1);
     }
 
-  public:
-    InputReader(Terminal &terminal) :
-        terminal(terminal) {
-    }
-
-    char get() {
-      return get(std::chrono::milliseconds::max());
-    }
-
-    char get(const std::chrono::milliseconds &timeout) {
+    /**
+     * Makes room for at least <code>size</code> more bytes, compacting or growing the buffer as needed.
+     *
+     * @return the position to write the bytes to, followed by get_free() writable bytes
+     */
+    char* reserve(size_t size) {
       if (this->read_pos == this->write_pos) {
-        if (not read_terminal_input(timeout)) {
-          return 0;
-        }
+        this->read_pos = this->write_pos = 0;
       }
-      return this->buffer[this->read_pos];
-    }
-
-    char consume() {
-      if (this->read_pos == this->write_pos) {
-        if (not read_terminal_input(std::chrono::milliseconds::zero())) {
-          return 0;
+      if (get_free() < size) {
+        if (this->read_pos != 0) {
+          std::copy(this->buffer.begin() + this->read_pos, this->buffer.begin() + this->write_pos, this->buffer.begin());
+          this->write_pos -= this->read_pos;
+          this->read_pos = 0;
+        }
+        if (get_free() < size) {
+          this->buffer.resize(std::max(this->buffer.size() * 2, this->write_pos + size));
         }
       }
-      auto pos = this->read_pos;
-      this->read_pos = (this->read_pos + 1) % BUFFER_SIZE;
-      return this->buffer[pos];
+      return this->buffer.data() + this->write_pos;
     }
-  };
 
-  class InputParser {
-    Terminal &terminal;
-    InputReader reader;
-    std::vector<unsigned> csi_params;
-    bool csi_altered = false;
-
-  private:
-    void parse_esc();
-
-    void parse_ss3();
-    void parse_dcs();
-    void parse_csi();
-    void parse_csi_params();
-    void parse_csi_selector();
-    void parse_osc();
-    void parse_utf8(char first_byte);
-
-  private:
-    void new_key_event(const Char &c, InputEvent::Modifiers key_modifiers = InputEvent::NO_MODIFIERS) {
-      this->terminal.new_key_event(c, key_modifiers);
+    void commit(size_t size) {
+      this->write_pos += size;
     }
 
-    void new_key_event(KeyEvent::KeyCode key_code, InputEvent::Modifiers key_modifiers = InputEvent::NO_MODIFIERS) {
-      this->terminal.new_key_event(key_code, key_modifiers);
+    void skip(size_t size) {
+      this->read_pos += size;
     }
 
-    void new_mouse_event(bool pressed);
-
-    char get() {
-      return this->reader.get();
+    size_t get_free() const {
+      return this->buffer.size() - this->write_pos;
     }
 
-    char consume() {
-      return this->reader.consume();
+    size_t get_available() const {
+      return this->write_pos - this->read_pos;
     }
 
-    char consume(const std::chrono::milliseconds &timeout) {
-      if (auto c = this->reader.get(timeout)) {
-        this->reader.consume();
-        return c;
-      }
-      return 0;
+    std::string_view get_input() const {
+      return { this->buffer.data() + this->read_pos, get_available() };
     }
 
-  public:
-    InputParser(Terminal &terminal) :
-        terminal(terminal), reader(terminal) {
+    /**
+     * Takes size unread bytes starting offset bytes into the unread input out of the buffer.
+     */
+    void remove(size_t offset, size_t size) {
+      auto from = this->buffer.begin() + this->read_pos + offset;
+      std::copy(from + size, this->buffer.begin() + this->write_pos, from);
+      this->write_pos -= size;
     }
-
-    void parse_event();
   };
 
   using Clock = std::chrono::steady_clock;
 
+  enum class ColorDepth {
+    PALETTE16,
+    PALETTE256,
+    TRUE_COLOR
+  };
+
 private:
   bool quit;
 
@@ -219,43 +192,105 @@ private:
   } prev_mouse_event;
   InputEvent::Modifiers modifiers = InputEvent::NO_MODIFIERS;
   Clock::time_point prev_mouse_press_time;
+
+  // The latest motion of the input being parsed, posted once anything else comes in or the input is parsed,
+  // so that a burst of motion reports results in one move or drag event.
+  struct MouseMotion {
+    std::shared_ptr<Window> window;
+    // The button being dragged, NO_BUTTON for a move.
+    MousePressEvent::Button button;
+    InputEvent::Modifiers modifiers;
+    Point p;
+  };
+  std::optional<MouseMotion> pending_mouse_motion;
+  size_t coalesced_mouse_motion_count = 0;
   Clock::time_point prev_mouse_click_time;
 
-  std::chrono::milliseconds read_input_timeout { 20 };
   std::chrono::milliseconds mouse_click_detection_timeout { 400 };
   std::chrono::milliseconds mouse_double_click_detection_timeout { 300 };
 
+  std::chrono::milliseconds capabilities_detection_timeout { 200 };
+  // Set by new_resize_event(), the screen is resized by read_events().
+  bool resize_pending = false;
+  // How long a lone ESC waits for the rest of a sequence before it is taken for the Escape key.
+  std::chrono::milliseconds escape_timeout { 25 };
+  // How long an unfinished paste waits for its end before it is reported as it is.
+  std::chrono::milliseconds paste_timeout { 250 };
+  // When input last came in, the timeouts above run from there.
+  Clock::time_point input_time;
+
   std::unique_ptr<TerminalImpl> impl;
 
+  // What the terminal supports beyond the VT100 basics, see detect_capabilities().
+  struct Capabilities {
+    ColorDepth color_depth = ColorDepth::PALETTE16;
+    // REP, repeating the preceding graphic character.
+    bool repeat_char = false;
+    // Mode 2026, synchronized output.
+    bool synchronized_output = false;
+    // Mode 1006, SGR mouse reports.
+    bool sgr_mouse = false;
+    // The kitty keyboard protocol.
+    bool kitty_keyboard = false;
+  } capabilities;
+
+  InputBuffer input_buffer;
   InputParser input_parser { *this };
 
+  // Everything written to the terminal is collected here and handed to the OS once per flush().
+  std::string output_buffer;
+  size_t last_flush_size = 0;
+  size_t total_bytes_written = 0;
+
 private:
   void set_option(Option option);
   void reset_option(Option option);
 
   void init();
   void deinit();
+  void detect_capabilities();
+
+  /**
+   * Waits up to timeout for the replies to the queries sent by detect_capabilities() and takes them out of the input,
+   * leaving anything else, keys typed meanwhile, to read_events().
+   *
+   * @return true if all the replies came in time, the reply to DA1 being the last of them
+   */
+  bool parse_replies(const std::chrono::milliseconds &timeout);
+  size_t parse_reply(std::string_view input, bool &device_attributes);
 
   void new_resize_event();
-  void new_key_event(const Char &c, InputEvent::Modifiers key_modifiers);
-  void new_key_event(KeyEvent::KeyCode key_code, InputEvent::Modifiers key_modifiers);
-  void new_mouse_event(MousePressEvent::Type type, MousePressEvent::Button button, InputEvent::Modifiers key_modifiers, int x, int y);
-  void new_mouse_wheel_event(int wheel_rotation, InputEvent::Modifiers key_modifiers, int x, int y);
+  void new_key_event(const Char &c, InputEvent::Modifiers key_modifiers) override;
+  void new_key_event(KeyEvent::KeyCode key_code, InputEvent::Modifiers key_modifiers) override;
+  void new_mouse_event(MousePressEvent::Type type, MousePressEvent::Button button, InputEvent::Modifiers key_modifiers, int x, int y) override;
+  void new_mouse_wheel_event(int wheel_rotation, InputEvent::Modifiers key_modifiers, int x, int y) override;
+  void new_paste_event(std::string_view text) override;
+  void post_pending_mouse_motion();
 //  void new_mouse_move_event(InputEvent::Modifiers modifiers, int x, int y);
 //  void new_mouse_drag_event(MousePressEvent::Button button, InputEvent::Modifiers modifiers, int x, int y);
 //  void new_mouse_click_event(MousePressEvent::Button button, InputEvent::Modifiers modifiers, int x, int y);
 
   friend class TerminalImpl;
-  friend class InputParser;
 
 private:
   bool read_input(const std::chrono::milliseconds &timeout, InputBuffer &into);
 
-  void read_events() {
-    this->input_parser.parse_event();
+  /**
+   * Waits up to timeout (forever if it is milliseconds::max()) for input or a wakeup() and parses whatever has arrived.
+   */
+  void read_events(const std::chrono::milliseconds &timeout);
+
+  /**
+   * Interrupts read_events() waiting in another thread. Safe to call from any thread.
+   */
+  void wakeup();
+
+  Terminal& write(const char *data, size_t size) {
+    this->output_buffer.append(data, size);
+    return *this;
   }
 
-  Terminal& write(const char *data, size_t size);
+  bool write_output(const char *data, size_t size);
 
   friend Terminal& operator<<(Terminal &term, std::string_view const &value);
   friend Terminal& operator<<(Terminal &term, std::string const &value);
@@ -288,6 +323,24 @@ public:
 
   void flush();
 
+  /**
+   * @return the number of bytes written to the terminal by the last flush(), i.e. the size of the last frame
+   */
+  size_t get_last_flush_size() const {
+    return this->last_flush_size;
+  }
+
+  size_t get_total_bytes_written() const {
+    return this->total_bytes_written;
+  }
+
+  /**
+   * @return the number of mouse motion reports merged into a later one of the same input, instead of being posted
+   */
+  size_t get_coalesced_mouse_motion_count() const {
+    return this->coalesced_mouse_motion_count;
+  }
+
   void run_event_loop() {
     screen.run_event_loop();
   }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <variant>
 
@@ -298,10 +299,90 @@ constexpr TrueColor complementary(TrueColor const &rgb) {
   return {uint8_t(255U - rgb.red), uint8_t(255U - rgb.green), uint8_t(255U - rgb.blue)};
 }
 
+/**
+ * Memoizes a conversion from TrueColor in a direct-mapped table. A theme uses a few dozen distinct colors, so after the first
+ * frame nearly every conversion is a single lookup.
+ */
+template<typename Color, Color (*convert)(TrueColor const&), std::size_t SIZE_LOG2 = 8>
+class TrueColorCache {
+  struct Entry {
+    uint32_t rgb;
+    Color color;
+  };
+
+  std::array<Entry, std::size_t(1) << SIZE_LOG2> entries;
+
+public:
+  TrueColorCache() {
+    // Every entry starts out valid, holding fully transparent black.
+    auto const transparent = TrueColor { 0, 0, 0, 0 };
+    this->entries.fill( { transparent.value, convert(transparent) });
+  }
+
+  Color operator()(TrueColor const &rgb) {
+    auto &entry = this->entries[uint32_t(rgb.value * 0x9E3779B1U) >> (32 - SIZE_LOG2)];
+    if (entry.rgb != rgb.value) {
+      entry = { rgb.value, convert(rgb) };
+    }
+    return entry.color;
+  }
+};
+
 }
 
 using TerminalColor = std::variant<detail::DefaultColor, detail::Palette16Color, detail::Palette256Color, detail::TrueColor>;
 
+namespace detail {
+
+/**
+ * A true color by its index if it is exactly one of the 6x6x6 cube or of the grayscale ramp, which is shorter to name,
+ * as is otherwise. The first 16 palette colors are never used for it, terminals let the user theme them.
+ */
+constexpr TerminalColor to_indexed_if_exact(TrueColor const &rgb) {
+  if (auto indexed = to_palette256(rgb); indexed.index >= 16 and to_rgb(indexed) == rgb) {
+    return indexed;
+  }
+  return rgb;
+}
+
+}
+
+/**
+ * A TerminalColor packed into 32 bits: the variant index in the top byte, the palette index or the RGB value below it.
+ */
+class PackedTerminalColor {
+  uint32_t value = 0;
+
+public:
+  constexpr PackedTerminalColor() = default;
+
+  constexpr PackedTerminalColor(TerminalColor const &color) :
+      value(uint32_t(color.index()) << 24) {
+    if (auto palette16 = std::get_if<detail::Palette16Color>(&color)) {
+      this->value |= palette16->index;
+    } else if (auto palette256 = std::get_if<detail::Palette256Color>(&color)) {
+      this->value |= palette256->index;
+    } else if (auto rgb = std::get_if<detail::TrueColor>(&color)) {
+      this->value |= rgb->value & 0xFFFFFF;
+    }
+  }
+
+  constexpr operator TerminalColor() const {
+    switch (this->value >> 24) {
+    case 1:
+      return detail::Palette16Color { uint8_t(this->value) };
+    case 2:
+      return detail::Palette256Color { uint8_t(this->value) };
+    case 3:
+      return detail::TrueColor { this->value };
+    default:
+      return detail::DefaultColor { };
+    }
+  }
+
+  constexpr bool operator==(const PackedTerminalColor &other) const = default;
+};
+
 /*@formatter:off*/
 constexpr TerminalColor BLACK                = detail::Palette16Color { 0 };
 constexpr TerminalColor RED                  = detail::Palette16Color { 1 };
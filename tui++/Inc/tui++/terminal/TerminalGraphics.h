@@ -2,6 +2,8 @@
 
 #include <tui++/Graphics.h>
 
+#include <vector>
+
 namespace tui {
 
 class TerminalScreen;
@@ -40,6 +42,19 @@ private:
   std::optional<Color> background_color;
   std::optional<Attributes> attributes;
 
+  struct State {
+    Font font;
+    int dx, dy;
+    Rectangle clip;
+    Stroke stroke;
+    std::optional<Color> foreground_color;
+    std::optional<Color> background_color;
+    std::optional<Attributes> attributes;
+  };
+
+  // The states pushed by save(). The vector keeps its capacity, so it only allocates when painting goes deeper than before.
+  std::vector<State> saved_states;
+
 public:
   TerminalGraphics(TerminalScreen &screen);
   TerminalGraphics(TerminalScreen &screen, const Rectangle &clip_rect, int dx, int dy);
@@ -58,6 +73,9 @@ public:
 
   virtual std::unique_ptr<Graphics> create(int x, int y, int width, int height) override;
 
+  virtual void save() override;
+  virtual void restore() override;
+
   virtual void draw_char(const Char &c, int x, int y, std::optional<Attributes> const &attributes = std::nullopt) override;
 
   virtual void draw_hline(int x, int y, int length, std::optional<Attributes> const &attributes = std::nullopt) override;
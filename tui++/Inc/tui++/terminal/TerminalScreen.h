@@ -1,5 +1,8 @@
 #pragma once
 
+#include <span>
+#include <atomic>
+#include <chrono>
 #include <vector>
 #include <optional>
 
@@ -19,42 +22,115 @@ class TerminalGraphics;
 
 class TerminalScreen: public Screen {
   using base = Screen;
+  using Clock = std::chrono::steady_clock;
 
+public:
+  struct FrameStats {
+    // Frames printed.
+    uint64_t frames = 0;
+    // Requests for a frame that were folded into the one already pending.
+    uint64_t coalesced = 0;
+    // Frame ticks that passed with a frame pending but not printed, because the event loop was busy.
+    uint64_t dropped = 0;
+  };
+
+private:
+
+  // A screen cell packed into 16 bytes, with no padding, so that rows can be compared and moved as plain memory.
   struct CharView {
-    Char ch = ' ';
+    uint32_t code :21 = ' ';
+    // The display width of the character, cached when the cell is drawn.
+    uint32_t width :2 = 1;
+    // The cell is the right half of the wide glyph to the left of it.
+    uint32_t continuation :1 = false;
+    uint32_t reserved :8 = 0;
     Attributes attributes = Attributes::NONE;
-    TerminalColor foreground_color = { };
-    TerminalColor background_color = { };
+    PackedTerminalColor foreground_color = { };
+    PackedTerminalColor background_color = { };
+
+    Char get_char() const {
+      return char32_t(this->code);
+    }
+
+    void set_char(Char ch) {
+      this->code = ch.get_code();
+    }
 
     const size_t get_width() const {
-      return util::glyph_width(this->ch);
+      return this->width;
     }
 
     const bool is_wide() const {
-      return get_width() == 2;
+      return this->width == 2;
     }
+
+    bool operator==(const CharView &other) const = default;
   };
 
+  static_assert(sizeof(CharView) == 16);
+
   static CharView EMPTY_CHAR_VIEW;
 
-  std::vector</* rows */std::vector</* columns */CharView>> view;
+  // The back buffer, painted by TerminalGraphics. Rows are stored one after another, size.width cells each.
+  std::vector<CharView> view;
+  // Rows of the back buffer drawn into since the last print(), the others are known to match the front buffer.
+  std::vector<uint8_t> dirty_rows;
+  // The front buffer, what the terminal is currently showing.
+  std::vector<CharView> front_view;
+  bool front_view_valid = false;
+  // Hashes of the front buffer rows and, while printing, of the back buffer rows, to detect rows that moved.
+  std::vector<uint64_t> front_row_hashes;
+  std::vector<uint64_t> row_hashes;
+  uint64_t empty_row_hash = 0;
+
+  // Downgrading true colors for terminals with fewer of them.
+  detail::TrueColorCache<detail::Palette16Color, detail::to_palette16> palette16_cache;
+  detail::TrueColorCache<detail::Palette256Color, detail::to_palette256> palette256_cache;
+  detail::TrueColorCache<TerminalColor, detail::to_indexed_if_exact> true_color_cache;
+
+  // flush() and refresh() only ask for a frame, the event loop prints at most one per frame_interval. The frame
+  // scheduling is done by the event dispatching thread alone, other threads post their requests to it.
+  std::chrono::nanoseconds frame_interval { 1'000'000'000 / 60 };
+  Clock::time_point next_frame_time;
+  Clock::time_point frame_due_time;
+  bool frame_pending = false;
+  std::atomic<bool> frame_request_posted = false;
+  std::atomic<bool> refresh_pending = false;
+  FrameStats frame_stats;
+
+  std::span<CharView> get_row(std::vector<CharView> &view, int y) {
+    return { view.data() + size_t(y) * this->size.width, size_t(this->size.width) };
+  }
 
 private:
   TerminalScreen() noexcept;
 
   void terminal_resized();
+  void request_frame();
+  std::chrono::milliseconds get_time_to_frame() const;
+  void print_frame();
   void print();
+  void scroll_moved_rows();
 
   friend class Terminal;
 
 private:
   void resize_view();
+  void invalidate_front_view();
 
   TerminalColor to_terminal(Color const& c);
 
   void draw_char(Char ch, int x, int y, std::optional<Color> const &foreground_color, std::optional<Color> const &background_color, std::optional<Attributes> const &attributes) {
-    auto &cv = this->view[y][x];
-    cv.ch = ch;
+    draw_char(ch, ch.glyph_width(), x, y, foreground_color, background_color, attributes);
+  }
+
+  void draw_char(Char ch, int width, int x, int y, std::optional<Color> const &foreground_color, std::optional<Color> const &background_color, std::optional<Attributes> const &attributes) {
+    auto row = get_row(this->view, y);
+    auto &cv = row[x];
+    this->dirty_rows[y] = true;
+    break_wide_char(row, x);
+    cv.set_char(ch);
+    cv.width = uint8_t(std::max(width, 0));
     if (attributes) {
       cv.attributes = attributes.value();
     }
@@ -64,6 +140,32 @@ private:
     if (background_color) {
       cv.background_color = to_terminal(background_color.value());
     }
+    if (cv.width == 2 and x + 1 < int(row.size())) {
+      break_wide_char(row, x + 1);
+      auto &right = row[x + 1];
+      right = cv;
+      right.code = ' ';
+      right.width = 0;
+      right.continuation = true;
+    }
+  }
+
+  void fill_rect(Char ch, Rectangle const &rect, std::optional<Color> const &foreground_color, std::optional<Color> const &background_color, std::optional<Attributes> const &attributes);
+
+  // Blanks the other half of the wide glyph cell x is part of, if any, since x is about to be overwritten.
+  static void break_wide_char(std::span<CharView> row, int x) {
+    auto &cv = row[x];
+    if (cv.continuation) {
+      cv.continuation = false;
+      cv.width = 1;
+      if (x > 0 and row[x - 1].width == 2) {
+        row[x - 1].code = ' ';
+        row[x - 1].width = 1;
+      }
+    } else if (cv.width == 2 and x + 1 < int(row.size()) and row[x + 1].continuation) {
+      row[x + 1].continuation = false;
+      row[x + 1].width = 1;
+    }
   }
 
   friend class TerminalGraphics;
@@ -79,7 +181,17 @@ public:
   virtual void refresh();
 
   void clear();
-  void flush();
+  virtual void flush() override;
+  virtual void flush_immediately() override;
+
+  /**
+   * Limits the frames printed per second, 0 prints a frame as soon as the events at hand are dispatched.
+   */
+  void set_max_fps(unsigned max_fps);
+
+  const FrameStats& get_frame_stats() const {
+    return this->frame_stats;
+  }
 };
 
 }
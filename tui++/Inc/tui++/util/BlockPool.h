@@ -0,0 +1,177 @@
+#pragma once
+
+#include <new>
+#include <mutex>
+#include <memory>
+#include <cstddef>
+
+namespace tui::util {
+
+/**
+ * Free list of equally sized blocks carved out of slabs that are never given back to the heap.
+ *
+ * Every thread allocates from and frees to a cache of its own, without locking. A cache that runs empty takes a batch
+ * of blocks from the blocks shared by all threads, or a new slab, one that grows too long gives a batch back, so blocks
+ * allocated in one thread and freed in another do not pile up.
+ */
+template<std::size_t BLOCK_SIZE>
+class BlockPool {
+  static_assert(BLOCK_SIZE % alignof(std::max_align_t) == 0);
+
+  constexpr static std::size_t BATCH_SIZE = 64;
+  constexpr static std::size_t MAX_CACHE_SIZE = 4 * BATCH_SIZE;
+
+  struct Block {
+    Block *next;
+  };
+
+  struct Blocks {
+    Block *head = nullptr;
+    std::size_t size = 0;
+
+    void push(Block *block) {
+      block->next = this->head;
+      this->head = block;
+      this->size += 1;
+    }
+
+    Block* pop() {
+      auto block = this->head;
+      this->head = block->next;
+      this->size -= 1;
+      return block;
+    }
+  };
+
+  struct Cache: Blocks {
+    ~Cache() {
+      BlockPool::shared().give(*this, this->size);
+      cache_destroyed = true;
+    }
+  };
+
+  class Shared {
+    std::mutex mutex;
+    Blocks blocks;
+
+    void add_slab() {
+      auto slab = static_cast<std::byte*>(::operator new(BLOCK_SIZE * BATCH_SIZE));
+      for (auto i = BATCH_SIZE; i > 0; --i) {
+        this->blocks.push(reinterpret_cast<Block*>(slab + (i - 1) * BLOCK_SIZE));
+      }
+    }
+
+  public:
+    void take(Blocks &into) {
+      std::lock_guard lock { this->mutex };
+      if (this->blocks.size == 0) {
+        add_slab();
+      }
+      while (this->blocks.size != 0 and into.size < BATCH_SIZE) {
+        into.push(this->blocks.pop());
+      }
+    }
+
+    void give(Blocks &from, std::size_t size) {
+      std::lock_guard lock { this->mutex };
+      while (size-- > 0) {
+        this->blocks.push(from.pop());
+      }
+    }
+
+    Block* take_one() {
+      std::lock_guard lock { this->mutex };
+      if (this->blocks.size == 0) {
+        add_slab();
+      }
+      return this->blocks.pop();
+    }
+
+    void give_one(Block *block) {
+      std::lock_guard lock { this->mutex };
+      this->blocks.push(block);
+    }
+  };
+
+  // Never destroyed, blocks may be freed by the destructors of other statics after those of this file have run.
+  static Shared& shared() {
+    static Shared &shared = *new Shared;
+    return shared;
+  }
+
+  inline static thread_local Cache cache;
+  // Set once the cache of the thread is gone, the blocks its thread_local and static destructors free go to shared().
+  inline static thread_local bool cache_destroyed = false;
+
+public:
+  static void* allocate() {
+    if (cache_destroyed) {
+      return shared().take_one();
+    } else if (cache.size == 0) {
+      shared().take(cache);
+    }
+    return cache.pop();
+  }
+
+  static void deallocate(void *p) {
+    if (cache_destroyed) {
+      shared().give_one(static_cast<Block*>(p));
+      return;
+    }
+    cache.push(static_cast<Block*>(p));
+    if (cache.size > MAX_CACHE_SIZE) {
+      shared().give(cache, BATCH_SIZE);
+    }
+  }
+};
+
+/**
+ * Allocator of single objects from the BlockPool of their size, arrays come from the heap.
+ */
+template<typename T>
+class PoolAllocator {
+  constexpr static std::size_t BLOCK_SIZE = (sizeof(T) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+public:
+  using value_type = T;
+
+  PoolAllocator() = default;
+
+  template<typename U>
+  PoolAllocator(const PoolAllocator<U>&) noexcept {
+  }
+
+  T* allocate(std::size_t n) {
+    if constexpr (alignof(T) <= alignof(std::max_align_t)) {
+      if (n == 1) {
+        return static_cast<T*>(BlockPool<BLOCK_SIZE>::allocate());
+      }
+    }
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T *p, std::size_t n) {
+    if constexpr (alignof(T) <= alignof(std::max_align_t)) {
+      if (n == 1) {
+        BlockPool<BLOCK_SIZE>::deallocate(p);
+        return;
+      }
+    }
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  template<typename U>
+  bool operator==(const PoolAllocator<U>&) const noexcept {
+    return true;
+  }
+};
+
+/**
+ * std::make_shared() with the object and its reference counts in one block from the pool.
+ */
+template<typename T, typename ... Args>
+std::shared_ptr<T> make_pooled(Args &&... args) {
+  return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
+}
+
+}
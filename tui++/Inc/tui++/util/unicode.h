@@ -1,11 +1,12 @@
 #pragma once
 
+#include <span>
 #include <array>
-#include <bitset>
 #include <cstddef>
 #include <cstdint>
 #include <utility>
-#include <initializer_list>
+#include <type_traits>
+#include <algorithm>
 
 namespace tui::util::unicode {
 
@@ -38,24 +39,112 @@ enum class WordBreak : uint8_t {
   ZWJ,
 };
 
-constexpr class WordBreakMap {
-  std::array<WordBreak, UNICODE_CHAR_COUNT> map = { };
+namespace detail {
+
+constexpr size_t CODE_POINT_BLOCK_SHIFT = 8;
+constexpr size_t CODE_POINT_BLOCK_SIZE = 1 << CODE_POINT_BLOCK_SHIFT;
+constexpr size_t CODE_POINT_BLOCK_COUNT = UNICODE_CHAR_COUNT >> CODE_POINT_BLOCK_SHIFT;
+
+/**
+ * Walks the blocks touched by the sorted, non-overlapping intervals. Calls uniform(block, value) for every block entirely covered
+ * by a single interval and mixed(block, interval) for every other one, interval being the first one overlapping the block.
+ * Blocks not touched by any interval are skipped, they map to T { }.
+ */
+template<typename T, typename Uniform, typename Mixed>
+constexpr void for_each_block(std::span<const std::pair<CodePointInterval, T>> intervals, Uniform &&uniform, Mixed &&mixed) {
+  auto next_block = size_t(0);
+  for (auto it = intervals.begin(); it != intervals.end();) {
+    auto block = std::max(size_t(it->first.from >> CODE_POINT_BLOCK_SHIFT), next_block);
+    auto from = char32_t(block << CODE_POINT_BLOCK_SHIFT), to = char32_t(from + CODE_POINT_BLOCK_SIZE - 1);
+    if (it->first.from <= from and it->first.to >= to) {
+      uniform(block, it->second);
+    } else {
+      mixed(block, it);
+    }
+    next_block = block + 1;
+    while (it != intervals.end() and it->first.to <= to) {
+      ++it;
+    }
+  }
+}
+
+template<typename T>
+constexpr size_t count_blocks(std::span<const std::pair<CodePointInterval, T>> intervals) {
+  auto count = size_t(1); // the block of T { }
+  T uniform_values[CODE_POINT_BLOCK_COUNT] = { };
+  auto uniform_count = size_t(0);
+  for_each_block(intervals, [&](size_t, T value) {
+    if (value != T { } and std::find(uniform_values, uniform_values + uniform_count, value) == uniform_values + uniform_count) {
+      uniform_values[uniform_count++] = value;
+      ++count;
+    }
+  }, [&](size_t, auto) {
+    ++count;
+  });
+  return count;
+}
+
+}
+
+/**
+ * Two-stage lookup table over the code point space. The first stage maps every block of 256 code points to a block of values
+ * in the second stage. Blocks having the same value for all their code points are shared, so only blocks crossing an interval
+ * boundary take up space of their own.
+ *
+ * The table is built at compile time from a sorted list of non-overlapping intervals, see make_code_point_map(). Code points
+ * outside of the intervals map to T { }.
+ */
+template<typename T, size_t BlockCount>
+class CodePointMap {
+  using BlockIndex = std::conditional_t<BlockCount <= 0x100, uint8_t, uint16_t>;
+
+  // Zero-initialized index entries refer to the first block which holds T { }.
+  std::array<BlockIndex, detail::CODE_POINT_BLOCK_COUNT> index = { };
+  std::array<std::array<T, detail::CODE_POINT_BLOCK_SIZE>, BlockCount> blocks = { };
+
 public:
-  constexpr WordBreakMap(std::initializer_list<std::pair<CodePointInterval, WordBreak>> list) {
-    for (auto&& [interval, word_break] : list) {
-      for (auto ch = interval.from; ch <= interval.to; ++ch) {
-        this->map[ch] = word_break;
+  constexpr CodePointMap(std::span<const std::pair<CodePointInterval, T>> intervals) {
+    using namespace detail;
+
+    BlockIndex uniform_blocks[BlockCount] = { };
+    auto uniform_count = size_t(1), block_count = size_t(1);
+    for_each_block(intervals, [&](size_t block, T value) {
+      auto u = std::find_if(uniform_blocks, uniform_blocks + uniform_count, [&](auto b) {
+        return this->blocks[b][0] == value;
+      });
+      if (u == uniform_blocks + uniform_count) {
+        this->blocks[block_count].fill(value);
+        uniform_blocks[uniform_count++] = BlockIndex(block_count++);
       }
-    }
+      this->index[block] = *u;
+    }, [&](size_t block, auto it) {
+      auto from = char32_t(block << CODE_POINT_BLOCK_SHIFT), to = char32_t(from + CODE_POINT_BLOCK_SIZE - 1);
+      std::array<T, CODE_POINT_BLOCK_SIZE> values = { };
+      for (; it != intervals.end() and it->first.from <= to; ++it) {
+        for (auto ch = std::max(it->first.from, from); ch <= std::min(it->first.to, to); ++ch) {
+          values[ch - from] = it->second;
+        }
+      }
+      this->blocks[block_count] = values;
+      this->index[block] = BlockIndex(block_count++);
+    });
   }
 
-  constexpr WordBreak operator[](char32_t cp) const {
-    if (cp < this->map.size()) {
-      return this->map[cp];
+  constexpr T operator[](char32_t cp) const {
+    if (cp < UNICODE_CHAR_COUNT) {
+      return this->blocks[this->index[cp >> detail::CODE_POINT_BLOCK_SHIFT]][cp & (detail::CODE_POINT_BLOCK_SIZE - 1)];
     }
-    return WordBreak::None;
+    return T { };
   }
-} word_break_map = //
+};
+
+template<auto const &Intervals>
+constexpr auto make_code_point_map() {
+  using Span = std::span<const std::pair<CodePointInterval, typename std::remove_cvref_t<decltype(Intervals[0])>::second_type>>;
+  return CodePointMap<typename Span::value_type::second_type, detail::count_blocks(Span { Intervals })> { Span { Intervals } };
+}
+
+constexpr std::pair<CodePointInterval, WordBreak> word_break_intervals[] = //
     // https://www.unicode.org/Public/UCD/latest/ucd/auxiliary/WordBreakProperty.txt
     { { { 0x0000A, 0x0000A }, WordBreak::LF }, //
       { { 0x0000B, 0x0000C }, WordBreak::Newline }, //
@@ -1347,24 +1436,9 @@ public:
       { { 0xE0100, 0xE01EF }, WordBreak::Extend }, //
     };
 
-constexpr class FullWidthMap {
-  std::bitset<UNICODE_CHAR_COUNT> map { };
-public:
-  constexpr FullWidthMap(std::initializer_list<CodePointInterval> list) {
-    for (auto &&interval : list) {
-      for (auto ch = interval.from; ch <= interval.to; ++ch) {
-        this->map[ch] = true;
-      }
-    }
-  }
+constexpr auto word_break_map = make_code_point_map<word_break_intervals>();
 
-  constexpr bool operator[](char32_t cp) const {
-    if (cp < this->map.size()) {
-      return this->map[cp];
-    }
-    return false;
-  }
-} full_width_map = //
+constexpr CodePointInterval full_width_intervals[] = //
     // As of Unicode 13.0.0
     { { 0x01100, 0x0115F }, { 0x0231A, 0x0231B }, { 0x02329, 0x0232A }, //
       { 0x023E9, 0x023EC }, { 0x023F0, 0x023F0 }, { 0x023F3, 0x023F3 }, //
@@ -1406,6 +1480,128 @@ public:
       { 0x1FAB0, 0x1FAB6 }, { 0x1FAC0, 0x1FAC2 }, { 0x1FAD0, 0x1FAD6 }, //
       { 0x20000, 0x2FFFD }, { 0x30000, 0x3FFFD }, };
 
+namespace detail {
+
+// Widths -1 to 2 take 2 bits each, encoded so that the most common width of 1 is 0.
+constexpr uint8_t encode_glyph_width(int width) {
+  return uint8_t(width - 1) & 0b11;
+}
+
+constexpr int decode_glyph_width(uint8_t code) {
+  constexpr int8_t widths[] = { 1, 2, -1, 0 };
+  return widths[code];
+}
+
+using GlyphWidthInterval = std::pair<CodePointInterval, uint8_t>;
+
+constexpr CodePointInterval control_intervals[] = { { 0x00000, 0x00009 }, { 0x0000B, 0x0001F }, { 0x0007F, 0x0009F } }; // except for line feed
+
+constexpr size_t EXTEND_INTERVAL_COUNT = std::ranges::count(word_break_intervals, WordBreak::Extend, &std::pair<CodePointInterval, WordBreak>::second);
+
+/**
+ * Control characters (-1), combining characters (0) and full width characters (2) as a sorted list of non-overlapping intervals.
+ * The earlier kinds take precedence, so full width intervals get cut by the others.
+ */
+constexpr struct GlyphWidthIntervals {
+  std::array<GlyphWidthInterval, 2 * (std::size(control_intervals) + EXTEND_INTERVAL_COUNT) + std::size(full_width_intervals)> intervals = { };
+  size_t size = 0;
+
+  constexpr GlyphWidthIntervals() {
+    for (auto &&interval : control_intervals) {
+      this->intervals[this->size++] = { interval, encode_glyph_width(-1) };
+    }
+    for (auto &&[interval, word_break] : word_break_intervals) {
+      if (word_break == WordBreak::Extend) {
+        this->intervals[this->size++] = { interval, encode_glyph_width(0) };
+      }
+    }
+
+    auto zero_width_count = this->size, z = size_t(0);
+    for (auto &&interval : full_width_intervals) {
+      auto from = interval.from;
+      for (; z < zero_width_count and this->intervals[z].first.from <= interval.to; ++z) {
+        if (auto &&cut = this->intervals[z].first; cut.to >= from) {
+          if (cut.from > from) {
+            this->intervals[this->size++] = { { from, cut.from - 1 }, encode_glyph_width(2) };
+          }
+          from = cut.to + 1;
+        }
+      }
+      if (z > 0 and this->intervals[z - 1].first.to > interval.to) {
+        --z; // may cut the next one as well
+      }
+      if (from <= interval.to) {
+        this->intervals[this->size++] = { { from, interval.to }, encode_glyph_width(2) };
+      }
+    }
+
+    std::sort(this->intervals.begin(), this->intervals.begin() + this->size, [](auto &&a, auto &&b) {
+      return a.first.from < b.first.from;
+    });
+  }
+
+  constexpr operator std::span<const GlyphWidthInterval>() const {
+    return { this->intervals.data(), this->size };
+  }
+} glyph_width_intervals;
+
+}
+
+/**
+ * Two-stage lookup table of glyph widths, 2 bits per code point. Same layout as CodePointMap with 4 code points packed into a
+ * byte.
+ */
+template<size_t BlockCount>
+class GlyphWidthMap {
+  constexpr static size_t CODES_PER_BYTE = 4;
+  constexpr static size_t BLOCK_BYTES = detail::CODE_POINT_BLOCK_SIZE / CODES_PER_BYTE;
+
+  using BlockIndex = std::conditional_t<BlockCount <= 0x100, uint8_t, uint16_t>;
+
+  std::array<BlockIndex, detail::CODE_POINT_BLOCK_COUNT> index = { };
+  std::array<std::array<uint8_t, BLOCK_BYTES>, BlockCount> blocks = { };
+
+public:
+  constexpr GlyphWidthMap(std::span<const detail::GlyphWidthInterval> intervals) {
+    using namespace detail;
+
+    BlockIndex uniform_blocks[BlockCount] = { };
+    auto uniform_count = size_t(1), block_count = size_t(1);
+    for_each_block(intervals, [&](size_t block, uint8_t code) {
+      auto packed = uint8_t(code * 0b01010101);
+      auto u = std::find_if(uniform_blocks, uniform_blocks + uniform_count, [&](auto b) {
+        return this->blocks[b][0] == packed;
+      });
+      if (u == uniform_blocks + uniform_count) {
+        this->blocks[block_count].fill(packed);
+        uniform_blocks[uniform_count++] = BlockIndex(block_count++);
+      }
+      this->index[block] = *u;
+    }, [&](size_t block, auto it) {
+      auto from = char32_t(block << CODE_POINT_BLOCK_SHIFT), to = char32_t(from + CODE_POINT_BLOCK_SIZE - 1);
+      std::array<uint8_t, BLOCK_BYTES> bytes = { };
+      for (; it != intervals.end() and it->first.from <= to; ++it) {
+        for (auto ch = std::max(it->first.from, from); ch <= std::min(it->first.to, to); ++ch) {
+          bytes[(ch - from) / CODES_PER_BYTE] |= it->second << ((ch - from) % CODES_PER_BYTE * 2);
+        }
+      }
+      this->blocks[block_count] = bytes;
+      this->index[block] = BlockIndex(block_count++);
+    });
+  }
+
+  constexpr int operator[](char32_t cp) const {
+    if (cp < UNICODE_CHAR_COUNT) {
+      auto offset = cp & (detail::CODE_POINT_BLOCK_SIZE - 1);
+      auto byte = this->blocks[this->index[cp >> detail::CODE_POINT_BLOCK_SHIFT]][offset / CODES_PER_BYTE];
+      return detail::decode_glyph_width((byte >> (offset % CODES_PER_BYTE * 2)) & 0b11);
+    }
+    return 1;
+  }
+};
+
+constexpr GlyphWidthMap<detail::count_blocks<uint8_t>(detail::glyph_width_intervals)> glyph_width_map { detail::glyph_width_intervals };
+
 constexpr bool is_control(char32_t cp) {
   if (cp == 0) {
     return true;
@@ -1421,20 +1617,15 @@ constexpr bool is_combining(char32_t cp) {
   return word_break_map[cp] == WordBreak::Extend;
 }
 
-constexpr bool is_full_width(char32_t cp) {
-  return full_width_map[cp];
+/**
+ * @return -1 for control characters, 0 for combining characters, 2 for full width characters and 1 for everything else
+ */
+constexpr int glyph_width(char32_t cp) {
+  return glyph_width_map[cp];
 }
 
-constexpr int glyph_width(char32_t cp) {
-  if (is_control(cp)) {
-    return -1;
-  } else if (is_combining(cp)) {
-    return 0;
-  } else if (is_full_width(cp)) {
-    return 2;
-  } else {
-    return 1;
-  }
+constexpr bool is_full_width(char32_t cp) {
+  return glyph_width(cp) == 2;
 }
 
 }
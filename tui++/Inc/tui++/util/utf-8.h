@@ -138,15 +138,20 @@ constexpr std::size_t glyph_width(const char *utf8, std::size_t size) {
   auto width = std::size_t { 0 };
   auto index = std::size_t { 0 };
   while (index < size) {
+    if (utf8[index] >= 0x20 and utf8[index] < 0x7F) {
+      // Printable ASCII needs neither decoding nor a table lookup.
+      width += 1;
+      index += 1;
+      continue;
+    }
+
     auto cp = char32_t { };
     auto cp_size = mb_to_c32(utf8 + index, size - index, &cp);
     if (cp_size < 0) {
       index += 1;
       continue;
-    } else if (unicode::is_full_width(cp)) {
-      width += 2;
-    } else if (not (unicode::is_control(cp) or unicode::is_combining(cp))) {
-      width += 1;
+    } else if (auto cp_width = unicode::glyph_width(cp); cp_width > 0) {
+      width += cp_width;
     }
     index += cp_size;
   }
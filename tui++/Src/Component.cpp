@@ -107,10 +107,13 @@ void Component::paint_children(Graphics &g) {
             }
           }
 
-          auto &&cg = g.create(bounds);
-          cg->set_foreground_color(c->get_foreground_color());
-          // cg->set_font(c->get_font());
-          c->paint(*cg);
+          g.save();
+          g.translate(bounds.x, bounds.y);
+          g.clip_rect(0, 0, bounds.width, bounds.height);
+          g.set_foreground_color(c->get_foreground_color());
+          // g.set_font(c->get_font());
+          c->paint(g);
+          g.restore();
         }
       }
     } while (i-- != 0);
@@ -237,7 +240,7 @@ bool Component::request_focus(bool temporary, bool focused_window_change_allowed
   KeyboardFocusManager::single->set_most_recent_focus_owner(shared_from_this());
 
   auto window = shared_from_this();
-  while (not std::dynamic_pointer_cast<Window>(window)) {
+  while (not is_window(window)) {
     if (not window->is_visible()) {
       // TODO
 //      if (focusLog.isLoggable(PlatformLogger.Level.FINEST)) {
@@ -372,8 +375,8 @@ void Component::transfer_focus_down_cycle() {
 
 std::shared_ptr<Window> Component::get_containing_window() const {
   for (auto component = const_cast<Component*>(this)->shared_from_this();; component = component->get_parent()) {
-    if (auto window = std::dynamic_pointer_cast<Window>(component)) {
-      return window;
+    if (is_window(component)) {
+      return std::static_pointer_cast<Window>(component);
     } else if (not component) {
       break;
     }
@@ -395,7 +398,7 @@ bool Component::process_key_bindings(KeyEvent &e) {
   }
 
   auto parent = get_parent();
-  for (; parent and not std::dynamic_pointer_cast<Window>(parent); parent = parent->get_parent()) {
+  for (; parent and not is_window(parent); parent = parent->get_parent()) {
     if (parent->process_key_binding(ks, e, WHEN_ANCESTOR_OF_FOCUSED_COMPONENT)) {
       return true;
     }
@@ -461,10 +464,6 @@ bool Component::is_showing() const {
   return false;
 }
 
-bool Component::is_window(const std::shared_ptr<const Component> &component) {
-  return is_a<Window>(component);
-}
-
 void Component::assert_adding_none_window(const std::shared_ptr<const Component> &c) noexcept (false) {
   if (is_window(c)) {
     throw std::runtime_error("Adding a window to a container");
@@ -574,15 +573,15 @@ void Component::dispatch_event(Event &e) {
     }
   }
 
-  log_focus_if_ln(dynamic_cast<FocusEvent*>(&e), *dynamic_cast<FocusEvent*>(&e));
+  log_focus_if_ln(e.id.type == EventType::FOCUS, static_cast<FocusEvent&>(e));
 
-  if (auto mouse_wheel_event = dynamic_cast<MouseWheelEvent*>(&e)) {
+  if (auto mouse_wheel_event = event_cast<MouseWheelEvent>(e)) {
     if (dispatch_mouse_wheel_to_ancestor(*mouse_wheel_event)) {
       return;
     }
   }
 
-  if (auto key_event = dynamic_cast<KeyEvent*>(&e)) {
+  if (auto key_event = event_cast<KeyEvent>(e)) {
     if (not key_event->consumed) {
       KeyboardFocusManager::single->process_key_event(shared_from_this(), *key_event);
       if (key_event->consumed) {
@@ -1246,7 +1245,13 @@ void Component::paint_immediately_impl(Rectangle const &bounds) const {
   }
 
   try {
-    if (auto g = c->get_graphics()) {
+    if (is_window(painting_component)) {
+      // A window paints in the coordinates of the screen, see Screen::paint() and Window::paint_children().
+      auto g = screen.get_graphics();
+      g->clip_rect(clip.x + painting_component->get_x(), clip.y + painting_component->get_y(), clip.width, clip.height);
+      painting_component->paint(*g);
+    } else if (auto g = painting_component->get_graphics()) {
+      g->clip_rect(clip);
       painting_component->paint(*g);
     }
   } catch (...) {
@@ -1310,7 +1315,7 @@ std::unique_ptr<Graphics> Component::get_graphics() const {
   if (auto parent = get_parent()) {
     auto g = parent->get_graphics();
     g->translate(get_x(), get_y());
-    g->set_clip_rect(0, 0, get_width(), get_height());
+    g->clip_rect(0, 0, get_width(), get_height());
     return g;
   } else {
     return screen.get_graphics(get_bounds());
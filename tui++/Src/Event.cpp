@@ -296,6 +296,11 @@ std::ostream& operator<<(std::ostream &os, const WindowEvent &event) {
   return os;
 }
 
+std::ostream& operator<<(std::ostream &os, const PasteEvent &event) {
+  os << "Text PASTED, " << event.text.size() << " bytes";
+  return os;
+}
+
 std::ostream& operator<<(std::ostream &os, const ComponentEvent &event) {
   return os;
 }
@@ -341,6 +346,9 @@ std::ostream& operator<<(std::ostream &os, const Event &event) {
   case EventType::KEY:
     os << static_cast<const KeyEvent&>(event);
     break;
+  case EventType::PASTE:
+    os << static_cast<const PasteEvent&>(event);
+    break;
   case EventType::MOUSE_PRESS:
     os << static_cast<const MousePressEvent&>(event);
     break;
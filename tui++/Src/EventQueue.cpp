@@ -1,41 +1,134 @@
 #include <tui++/EventQueue.h>
 
 namespace tui {
+
+EventQueue::EventQueue() {
+  for (auto i = 0U; i < RING_SIZE; ++i) {
+    this->ring[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+bool EventQueue::try_push(const std::shared_ptr<Event> &event) {
+  auto pos = this->write_pos.load(std::memory_order_relaxed);
+  for (;;) {
+    auto &cell = this->ring[pos & RING_MASK];
+    auto diff = intptr_t(cell.sequence.load(std::memory_order_acquire)) - intptr_t(pos);
+    if (diff == 0) {
+      if (this->write_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        cell.event = event;
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      return false; // full
+    } else {
+      pos = this->write_pos.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+std::shared_ptr<Event> EventQueue::dequeue() {
+  auto pos = this->read_pos.load(std::memory_order_relaxed);
+  auto &cell = this->ring[pos & RING_MASK];
+  if (cell.sequence.load(std::memory_order_acquire) == pos + 1) {
+    auto event = std::move(cell.event);
+    cell.sequence.store(pos + RING_SIZE, std::memory_order_release);
+    this->read_pos.store(pos + 1, std::memory_order_release);
+    return event;
+  }
+
+  if (this->overflow_size.load(std::memory_order_acquire) != 0) {
+    std::unique_lock lock(this->overflow_mutex);
+    if (not this->overflow.empty()) {
+      auto event = std::move(this->overflow.front());
+      this->overflow.pop_front();
+      this->overflow_size.store(this->overflow.size(), std::memory_order_release);
+      return event;
+    }
+  }
+  return {};
+}
+
 void EventQueue::push(const std::shared_ptr<Event> &event) {
-  std::unique_lock lock(this->mutex);
-  this->queue.emplace_back(event);
-  lock.unlock();
-  this->queue_cv.notify_one();
+  // Once events went to the overflow list, keep appending there until it is drained to preserve the order.
+  if (this->overflow_size.load(std::memory_order_acquire) != 0 or not try_push(event)) {
+    std::unique_lock lock(this->overflow_mutex);
+    this->overflow.emplace_back(event);
+    this->overflow_size.store(this->overflow.size(), std::memory_order_release);
+  }
+
+  // Pairs with the fence in pop(): either the consumer sees the event or we see it parked.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (this->consumer_parked.load(std::memory_order_relaxed)) {
+    wake_consumer();
+  }
+}
+
+void EventQueue::wake_consumer() {
+  {
+    std::unique_lock lock(this->park_mutex);
+    this->queue_cv.notify_one();
+  }
+  if (this->wakeup_handler) {
+    this->wakeup_handler();
+  }
 }
 
 std::shared_ptr<Event> EventQueue::pop() {
-  std::unique_lock lock(this->mutex);
-  this->queue_cv.wait(lock, [this] {
-    return not this->queue.empty();
-  });
-  auto event = std::move(this->queue.front());
-  this->queue.pop_front();
+  auto event = dequeue();
+  if (not event) {
+    std::unique_lock lock(this->park_mutex);
+    this->consumer_parked.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    this->queue_cv.wait(lock, [this, &event] {
+      return bool(event = dequeue());
+    });
+    this->consumer_parked.store(false, std::memory_order_relaxed);
+  }
   set_current_event(event);
   return event;
 }
 
 std::shared_ptr<Event> EventQueue::pop(const std::chrono::milliseconds &timeout) {
-  std::unique_lock lock(this->mutex);
-  if (this->queue.empty() and not this->queue_cv.wait_for(lock, timeout, [this] {
-    return not this->queue.empty();
-  })) {
-    return {};
-  }
-  auto event = std::move(this->queue.front());
-  this->queue.pop_front();
+  auto event = dequeue();
+  if (not event) {
+    std::unique_lock lock(this->park_mutex);
+    this->consumer_parked.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto popped = this->queue_cv.wait_for(lock, timeout, [this, &event] {
+      return bool(event = dequeue());
+    });
+    this->consumer_parked.store(false, std::memory_order_relaxed);
+    if (not popped) {
+      return {};
+    }
+  }
   set_current_event(event);
   return event;
 }
 
+std::shared_ptr<Event> EventQueue::try_pop() {
+  auto event = dequeue();
+  if (event) {
+    set_current_event(event);
+  }
+  return event;
+}
+
+bool EventQueue::park() {
+  this->consumer_parked.store(true, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  return empty();
+}
+
+void EventQueue::unpark() {
+  this->consumer_parked.store(false, std::memory_order_relaxed);
+}
+
 void EventQueue::set_current_event(std::shared_ptr<Event> const &event) {
   this->current_event = event;
   this->most_recent_event_time = std::max(this->most_recent_event_time.load(), event->when);
-  if (auto key_event = std::dynamic_pointer_cast<KeyEvent>(event)) {
+  if (event->id.type == EventType::KEY) {
     this->most_recent_key_event_time = event->when;
   }
 }
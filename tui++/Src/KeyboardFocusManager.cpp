@@ -31,12 +31,11 @@ void KeyboardFocusManager::clear_focus_owner() {
 
 void KeyboardFocusManager::set_most_recent_focus_owner(const std::shared_ptr<Component> &component) {
   auto parent = component;
-  auto window = std::shared_ptr<Window> { };
-  while (not (window = std::dynamic_pointer_cast<Window>(parent)) and parent) {
+  while (parent and not Component::is_window(parent)) {
     parent = parent->get_parent();
   }
-  if (window) {
-    set_most_recent_focus_owner(window, component);
+  if (parent) {
+    set_most_recent_focus_owner(std::static_pointer_cast<Window>(parent), component);
   }
 }
 
@@ -539,8 +538,8 @@ void KeyboardFocusManager::clear_most_recent_focus_owner(const std::shared_ptr<C
   if (c) {
     auto window = c->with_tree_locked([&c]() {
       for (auto parent = c->get_parent(); parent; parent = parent->get_parent()) {
-        if (auto window = std::dynamic_pointer_cast<Window>(parent)) {
-          return window;
+        if (Component::is_window(parent)) {
+          return std::static_pointer_cast<Window>(parent);
         }
       }
       return std::shared_ptr<Window> { };
@@ -54,7 +54,7 @@ void KeyboardManager::fire_binding(const std::shared_ptr<Component> &component,
 
 std::shared_ptr<Component> KeyboardManager::get_top_ancestor(const std::shared_ptr<Component> &c) {
   for (auto p = c->get_parent(); p; p = p->get_parent()) {
-    if (auto window = std::dynamic_pointer_cast<Window>(p); window and window->is_focusable_window()) {
+    if (Component::is_window(p) and std::static_pointer_cast<Window>(p)->is_focusable_window()) {
       return p;
     }
   }
@@ -16,7 +16,7 @@ RepaintManager::RepaintManager() {
 void RepaintManager::add_dirty_region(std::shared_ptr<Component> const &c, Rectangle const &bounds) {
   if (bounds.empty() or not c or c->get_width() <= 0 or c->get_height() <= 0) {
     return;
-  } else if (extend_dirty_region(c, bounds)) {
+  } else if (std::unique_lock lock { this->mutex }; extend_dirty_region(c, bounds)) {
     return;
   }
 
@@ -24,13 +24,13 @@ void RepaintManager::add_dirty_region(std::shared_ptr<Component> const &c, Recta
   for (auto p = c; p; p = p->get_parent()) {
     if (not p->is_visible() or not p->is_displayable()) {
       return;
-    } else if (auto window = std::dynamic_pointer_cast<Window>(p)) {
-      if (auto frame = std::dynamic_pointer_cast<Frame>(window)) {
-//        if (p->is_iconified()) {
+    } else if (Component::is_window(p)) {
+      if (Component::is_frame(p)) {
+//        if (std::static_pointer_cast<Frame>(p)->is_iconified()) {
 //          return;
 //        }
       }
-      root = window;
+      root = std::static_pointer_cast<Window>(p);
       break;
     }
   }
@@ -40,11 +40,14 @@ void RepaintManager::add_dirty_region(std::shared_ptr<Component> const &c, Recta
   }
 
   std::unique_lock lock { this->mutex };
-  if (auto &dirty_bounds = this->dirty_regions[c]; not dirty_bounds.empty()) {
-    dirty_bounds |= bounds;
+  if (extend_dirty_region(c, bounds)) {
     return;
-  } else {
-    dirty_bounds = bounds;
+  }
+
+  // Only the first dirty region of a batch schedules the repaint, the rest are picked up by it.
+  auto schedule_repaint = this->dirty_regions.empty();
+  this->dirty_regions.emplace(c, bounds);
+  if (schedule_repaint) {
     screen.post([self = shared_from_this()] {
       self->repaint_dirty_regions();
     });
@@ -59,8 +62,69 @@ bool RepaintManager::extend_dirty_region(std::shared_ptr<Component> const &c, Re
   return false;
 }
 
+/**
+ * Translates the dirty region of the component into its window coordinates, clipping it by the bounds of every ancestor.
+ */
+std::shared_ptr<Window> RepaintManager::to_window_region(std::shared_ptr<Component> const &c, Rectangle &region) {
+  region &= Rectangle { 0, 0, c->get_width(), c->get_height() };
+  for (auto p = c; p; p = p->get_parent()) {
+    if (region.empty() or not p->is_visible()) {
+      break;
+    } else if (Component::is_window(p)) {
+      return std::static_pointer_cast<Window>(p);
+    }
+    region.translate(p->get_x(), p->get_y());
+    if (auto parent = p->get_parent()) {
+      region &= Rectangle { 0, 0, parent->get_width(), parent->get_height() };
+    }
+  }
+  return {};
+}
+
 void RepaintManager::repaint_dirty_regions() {
+  auto dirty_regions = decltype(this->dirty_regions) { };
+  {
+    std::unique_lock lock { this->mutex };
+    dirty_regions.swap(this->dirty_regions);
+  }
+
+  // Coalesce the regions of all dirty components of a window into one screen rectangle.
+  auto window_regions = std::unordered_map<std::shared_ptr<Window>, Rectangle> { };
+  for (auto&& [c, bounds] : dirty_regions) {
+    auto region = bounds;
+    if (auto window = to_window_region(c, region); window and not region.empty()) {
+      region.translate(window->get_x(), window->get_y());
+      if (auto &window_region = window_regions[window]; window_region.empty()) {
+        window_region = region;
+      } else {
+        window_region |= region;
+      }
+    }
+  }
+
+  if (window_regions.empty()) {
+    return;
+  }
+
+  // Paint windows back to front, so that a window above a repainted region gets repainted over it.
+  auto damage = Rectangle { };
+  {
+    std::unique_lock lock { screen.windows_mutex };
+    for (auto &&window : screen.windows) {
+      auto region = window->get_bounds() & damage;
+      if (auto pos = window_regions.find(window); pos != window_regions.end()) {
+        region = region.empty() ? pos->second : region | pos->second;
+      }
+
+      if (not region.empty()) {
+        damage = damage.empty() ? region : damage | region;
+        region.translate(-window->get_x(), -window->get_y());
+        window->paint_immediately_impl(region);
+      }
+    }
+  }
 
+  screen.flush();
 }
 
 }
@@ -2,6 +2,7 @@
 #include <tui++/Window.h>
 #include <tui++/KeyboardFocusManager.h>
 
+#include <cassert>
 #include <stdexcept>
 
 namespace tui {
@@ -72,6 +73,11 @@ void Screen::focus(const std::shared_ptr<Window> &gained, const std::shared_ptr<
 void Screen::dispatch_event(Event &event) {
   if (event.id == InvocationEvent::INVOCATION) {
     static_cast<InvocationEvent&>(event).dispatch();
+  } else if (event.id & COMPONENT_SOURCE_EVENT_MASK) {
+    if (event.source) {
+      assert(dynamic_cast<Component*>(event.source.get()) != nullptr);
+      static_cast<Component&>(*event.source).dispatch_event(event);
+    }
   } else if (auto c = std::dynamic_pointer_cast<Component>(event.source)) {
     c->dispatch_event(event);
   }
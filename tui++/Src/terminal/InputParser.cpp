@@ -0,0 +1,511 @@
+#include <tui++/terminal/InputParser.h>
+
+#include <algorithm>
+#include <utility>
+
+using namespace std::string_view_literals;
+
+namespace tui {
+
+using State = InputParser::State;
+using Action = InputParser::Action;
+using Transitions = std::array<std::array<InputParser::Transition, 256>, std::size_t(State::COUNT)>;
+
+constexpr char STRING_TERMINATOR = '\\';
+constexpr char CAN = '\x18';
+constexpr char SUB = '\x1a';
+constexpr char ESC = '\x1b';
+
+constexpr auto PASTE_START = 200U;
+constexpr auto PASTE_END = "\x1b[201~"sv;
+
+static constexpr Transitions make_transitions() {
+  Transitions transitions { };
+
+  auto set = [&transitions](State state, unsigned char from, unsigned char to, Action action, State next) {
+    for (auto c = unsigned(from); c <= to; ++c) {
+      transitions[std::size_t(state)][c] = { action, next };
+    }
+  };
+  auto set_row = [&transitions](State state, State from) {
+    transitions[std::size_t(state)] = transitions[std::size_t(from)];
+  };
+
+  // Any C0 control is a key of its own, CAN and SUB cancel a sequence and ESC starts a new one.
+  for (auto state = State::GROUND; state != State::COUNT; state = State(std::size_t(state) + 1)) {
+    set(state, 0x00, 0x1f, Action::EXECUTE, state);
+    set(state, CAN, CAN, Action::NONE, State::GROUND);
+    set(state, SUB, SUB, Action::NONE, State::GROUND);
+    set(state, ESC, ESC, Action::NONE, State::ESCAPE);
+  }
+
+  set(State::GROUND, CAN, CAN, Action::EXECUTE, State::GROUND);
+  set(State::GROUND, SUB, SUB, Action::EXECUTE, State::GROUND);
+  set(State::GROUND, 0x20, 0x7e, Action::PRINT, State::GROUND);
+  set(State::GROUND, 0x7f, 0x7f, Action::EXECUTE, State::GROUND);
+  // Stray continuation bytes, overlong and out of range lead bytes are dropped.
+  set(State::GROUND, 0x80, 0xff, Action::NONE, State::GROUND);
+  set(State::GROUND, 0xc2, 0xf4, Action::UTF8_START, State::UTF8);
+
+  // Anything but a continuation byte abandons the character and is taken as in GROUND.
+  set_row(State::UTF8, State::GROUND);
+  set(State::UTF8, 0x80, 0xbf, Action::UTF8_CONTINUE, State::UTF8);
+
+  // What follows a lone ESC is a key pressed with Alt.
+  set(State::ESCAPE, 0x00, 0x1f, Action::ESC_DISPATCH, State::GROUND);
+  set(State::ESCAPE, CAN, CAN, Action::NONE, State::GROUND);
+  set(State::ESCAPE, SUB, SUB, Action::NONE, State::GROUND);
+  set(State::ESCAPE, ESC, ESC, Action::ESCAPE_KEY, State::ESCAPE);
+  set(State::ESCAPE, 0x20, 0x7f, Action::ESC_DISPATCH, State::GROUND);
+  set(State::ESCAPE, 0x80, 0xff, Action::NONE, State::GROUND);
+  set(State::ESCAPE, '[', '[', Action::CLEAR, State::CSI_ENTRY);
+  set(State::ESCAPE, 'O', 'O', Action::NONE, State::SS3);
+  // DCS, SOS, OSC, PM and APC, a string if a reply is expected, see InputParser::string_start(), Alt with the key if not.
+  for (auto introducer : { 'P', 'X', ']', '^', '_' }) {
+    set(State::ESCAPE, introducer, introducer, Action::STRING_START, State::GROUND);
+  }
+
+  set(State::SS3, 0x20, 0xff, Action::NONE, State::GROUND);
+  for (auto final : { 'A', 'B', 'C', 'D', 'H', 'F', 'P', 'Q', 'R', 'S' }) {
+    set(State::SS3, final, final, Action::SS3_DISPATCH, State::GROUND);
+  }
+
+  set(State::CSI_ENTRY, 0x20, 0x2f, Action::COLLECT, State::CSI_INTERMEDIATE);
+  set(State::CSI_ENTRY, 0x30, 0x39, Action::PARAM, State::CSI_PARAM);
+  set(State::CSI_ENTRY, 0x3a, 0x3a, Action::NONE, State::CSI_IGNORE);
+  set(State::CSI_ENTRY, 0x3b, 0x3b, Action::PARAM, State::CSI_PARAM);
+  set(State::CSI_ENTRY, 0x3c, 0x3f, Action::COLLECT, State::CSI_PARAM);
+  set(State::CSI_ENTRY, 0x40, 0x7e, Action::CSI_DISPATCH, State::GROUND);
+  set(State::CSI_ENTRY, 0x7f, 0x7f, Action::NONE, State::CSI_ENTRY);
+  set(State::CSI_ENTRY, 0x80, 0xff, Action::NONE, State::GROUND);
+
+  set(State::CSI_PARAM, 0x20, 0x2f, Action::COLLECT, State::CSI_INTERMEDIATE);
+  set(State::CSI_PARAM, 0x30, 0x39, Action::PARAM, State::CSI_PARAM);
+  set(State::CSI_PARAM, 0x3a, 0x3a, Action::NONE, State::CSI_IGNORE);
+  set(State::CSI_PARAM, 0x3b, 0x3b, Action::PARAM, State::CSI_PARAM);
+  set(State::CSI_PARAM, 0x3c, 0x3f, Action::NONE, State::CSI_IGNORE);
+  set(State::CSI_PARAM, 0x40, 0x7e, Action::CSI_DISPATCH, State::GROUND);
+  set(State::CSI_PARAM, 0x7f, 0x7f, Action::NONE, State::CSI_PARAM);
+  set(State::CSI_PARAM, 0x80, 0xff, Action::NONE, State::GROUND);
+
+  set(State::CSI_INTERMEDIATE, 0x20, 0x2f, Action::COLLECT, State::CSI_INTERMEDIATE);
+  set(State::CSI_INTERMEDIATE, 0x30, 0x3f, Action::NONE, State::CSI_IGNORE);
+  set(State::CSI_INTERMEDIATE, 0x40, 0x7e, Action::CSI_DISPATCH, State::GROUND);
+  set(State::CSI_INTERMEDIATE, 0x7f, 0x7f, Action::NONE, State::CSI_INTERMEDIATE);
+  set(State::CSI_INTERMEDIATE, 0x80, 0xff, Action::NONE, State::GROUND);
+
+  set(State::CSI_IGNORE, 0x20, 0x3f, Action::NONE, State::CSI_IGNORE);
+  set(State::CSI_IGNORE, 0x40, 0x7e, Action::NONE, State::GROUND);
+  set(State::CSI_IGNORE, 0x7f, 0x7f, Action::NONE, State::CSI_IGNORE);
+  set(State::CSI_IGNORE, 0x80, 0xff, Action::NONE, State::GROUND);
+
+  // Strings end with ST, ESC \, or, for OSC, BEL.
+  set(State::STRING, 0x00, 0xff, Action::NONE, State::STRING);
+  set(State::STRING, '\a', '\a', Action::NONE, State::GROUND);
+  set(State::STRING, CAN, CAN, Action::NONE, State::GROUND);
+  set(State::STRING, SUB, SUB, Action::NONE, State::GROUND);
+  set(State::STRING, ESC, ESC, Action::NONE, State::STRING_ESCAPE);
+
+  set_row(State::STRING_ESCAPE, State::ESCAPE);
+  set(State::STRING_ESCAPE, STRING_TERMINATOR, STRING_TERMINATOR, Action::NONE, State::GROUND);
+
+  // Pasted text is searched for the end of the paste as a whole rather than parsed, see InputParser::paste().
+  set(State::PASTE, 0x00, 0xff, Action::NONE, State::PASTE);
+
+  return transitions;
+}
+
+static constexpr Transitions transitions = make_transitions();
+
+static_assert(transitions[std::size_t(State::GROUND)]['a'].action == Action::PRINT);
+static_assert(transitions[std::size_t(State::ESCAPE)]['['].state == State::CSI_ENTRY);
+static_assert(transitions[std::size_t(State::STRING)][ESC].state == State::STRING_ESCAPE);
+static_assert(transitions[std::size_t(State::ESCAPE)]['P'].action == Action::STRING_START);
+
+size_t InputParser::parse(std::string_view input) {
+  for (size_t i = 0; i < input.size(); ++i) {
+    if (this->state == State::PASTE) {
+      if (auto size = paste(input.substr(i))) {
+        i += size - 1;
+        continue;
+      }
+      return i;
+    }
+
+    auto const c = input[i];
+    auto const transition = transitions[std::size_t(this->state)][std::uint8_t(c)];
+    this->state = transition.state;
+    if (transition.action != Action::NONE) {
+      perform(transition.action, c);
+    }
+  }
+  return input.size();
+}
+
+/**
+ * @return the size of the paste and its end input starts with, 0 if the end has not come yet
+ */
+size_t InputParser::paste(std::string_view input) {
+  auto const end = input.find(PASTE_END, this->paste_scanned);
+  if (end == input.npos) {
+    // The end may already have come in part.
+    this->paste_scanned = std::max(input.size(), PASTE_END.size() - 1) - (PASTE_END.size() - 1);
+    if (input.size() < MAX_PASTE_SIZE) {
+      return 0;
+    }
+
+    // What came so far is reported, the paste goes on with the rest.
+    auto const size = std::exchange(this->paste_scanned, 0);
+    this->listener.new_paste_event(input.substr(0, size));
+    return size;
+  }
+
+  this->state = State::GROUND;
+  this->paste_scanned = 0;
+  this->listener.new_paste_event(input.substr(0, end));
+  return end + PASTE_END.size();
+}
+
+size_t InputParser::flush(std::string_view input) {
+  auto size = size_t(0);
+  if (this->state == State::ESCAPE) {
+    this->listener.new_key_event(KeyEvent::VK_ESCAPE, InputEvent::NO_MODIFIERS);
+  } else if (this->state == State::PASTE) {
+    this->paste_scanned = 0;
+    this->listener.new_paste_event(input);
+    size = input.size();
+  }
+  this->state = State::GROUND;
+  return size;
+}
+
+void InputParser::perform(Action action, char c) {
+  switch (action) {
+  case Action::NONE:
+    break;
+
+  case Action::PRINT:
+    if (c == ' ') {
+      this->listener.new_key_event(KeyEvent::VK_SPACE, InputEvent::NO_MODIFIERS);
+    } else {
+      this->listener.new_key_event(char32_t(c), InputEvent::NO_MODIFIERS);
+    }
+    break;
+
+  case Action::EXECUTE:
+    execute(c);
+    break;
+
+  case Action::UTF8_START:
+    utf8_start(c);
+    break;
+
+  case Action::UTF8_CONTINUE:
+    utf8_continue(c);
+    break;
+
+  case Action::CLEAR:
+    this->csi_marker = 0;
+    this->csi_intermediate = 0;
+    this->csi_params[0] = 0;
+    this->csi_param_count = 1;
+    break;
+
+  case Action::ESCAPE_KEY:
+    this->listener.new_key_event(KeyEvent::VK_ESCAPE, InputEvent::NO_MODIFIERS);
+    break;
+
+  case Action::ESC_DISPATCH:
+    esc_dispatch(c);
+    break;
+
+  case Action::STRING_START:
+    string_start(c);
+    break;
+
+  case Action::SS3_DISPATCH:
+    ss3_dispatch(c);
+    break;
+
+  case Action::PARAM:
+    param(c);
+    break;
+
+  case Action::COLLECT:
+    if (c >= 0x3c) {
+      this->csi_marker = c;
+    } else {
+      this->csi_intermediate = c;
+    }
+    break;
+
+  case Action::CSI_DISPATCH:
+    csi_dispatch(c);
+    break;
+  }
+}
+
+void InputParser::execute(char c) {
+  switch (c) {
+  case '\b':
+  case '\x7f':
+    this->listener.new_key_event(KeyEvent::VK_BACK_SPACE, InputEvent::NO_MODIFIERS);
+    break;
+
+  case '\r':
+  case '\n':
+    this->listener.new_key_event(KeyEvent::VK_ENTER, InputEvent::NO_MODIFIERS);
+    break;
+
+  case '\t':
+    this->listener.new_key_event(KeyEvent::VK_TAB, InputEvent::NO_MODIFIERS);
+    break;
+
+  default:
+    this->listener.new_key_event(KeyEvent::KeyCode(char(c + 0x40)), InputEvent::CTRL_DOWN);
+    break;
+  }
+}
+
+void InputParser::utf8_start(char c) {
+  auto const lead = std::uint8_t(c);
+  this->utf8_bytes_left = lead >= 0xf0 ? 3 : lead >= 0xe0 ? 2 : 1;
+  this->utf8_code = lead & (0x3f >> this->utf8_bytes_left);
+}
+
+void InputParser::utf8_continue(char c) {
+  this->utf8_code = (this->utf8_code << 6) | (std::uint8_t(c) & 0x3f);
+  if (--this->utf8_bytes_left == 0) {
+    this->state = State::GROUND;
+    // An overlong encoding of ASCII is not a character.
+    if (this->utf8_code >= 0x80) {
+      this->listener.new_key_event(this->utf8_code, InputEvent::NO_MODIFIERS);
+    }
+  }
+}
+
+void InputParser::esc_dispatch(char c) {
+  if (c < ' ' or c == '\x7f') {
+    switch (c) {
+    case '\b':
+    case '\x7f':
+      this->listener.new_key_event(KeyEvent::VK_BACK_SPACE, InputEvent::ALT_DOWN);
+      break;
+    case '\r':
+    case '\n':
+      this->listener.new_key_event(KeyEvent::VK_ENTER, InputEvent::ALT_DOWN);
+      break;
+    case '\t':
+      this->listener.new_key_event(KeyEvent::VK_TAB, InputEvent::ALT_DOWN);
+      break;
+    default:
+      this->listener.new_key_event(KeyEvent::KeyCode(char(c + 0x40)), InputEvent::CTRL_DOWN | InputEvent::ALT_DOWN);
+      break;
+    }
+  } else {
+    this->listener.new_key_event(KeyEvent::KeyCode(c), InputEvent::ALT_DOWN);
+  }
+}
+
+void InputParser::string_start(char c) {
+  if (this->string_replies_expected == 0) {
+    esc_dispatch(c);
+  } else {
+    this->string_replies_expected -= 1;
+    this->state = State::STRING;
+  }
+}
+
+void InputParser::ss3_dispatch(char c) {
+  switch (c) {
+  case 'A':
+    this->listener.new_key_event(KeyEvent::VK_UP, InputEvent::NO_MODIFIERS);
+    break;
+  case 'B':
+    this->listener.new_key_event(KeyEvent::VK_DOWN, InputEvent::NO_MODIFIERS);
+    break;
+  case 'C':
+    this->listener.new_key_event(KeyEvent::VK_RIGHT, InputEvent::NO_MODIFIERS);
+    break;
+  case 'D':
+    this->listener.new_key_event(KeyEvent::VK_LEFT, InputEvent::NO_MODIFIERS);
+    break;
+  case 'H':
+    this->listener.new_key_event(KeyEvent::VK_HOME, InputEvent::NO_MODIFIERS);
+    break;
+  case 'F':
+    this->listener.new_key_event(KeyEvent::VK_END, InputEvent::NO_MODIFIERS);
+    break;
+  case 'P':
+    this->listener.new_key_event(KeyEvent::VK_F1, InputEvent::NO_MODIFIERS);
+    break;
+  case 'Q':
+    this->listener.new_key_event(KeyEvent::VK_F2, InputEvent::NO_MODIFIERS);
+    break;
+  case 'R':
+    this->listener.new_key_event(KeyEvent::VK_F3, InputEvent::NO_MODIFIERS);
+    break;
+  case 'S':
+    this->listener.new_key_event(KeyEvent::VK_F4, InputEvent::NO_MODIFIERS);
+    break;
+  }
+}
+
+void InputParser::param(char c) {
+  if (c == ';') {
+    if (this->csi_param_count < MAX_PARAMS) {
+      this->csi_params[this->csi_param_count++] = 0;
+    }
+  } else {
+    auto &value = this->csi_params[this->csi_param_count - 1];
+    value = std::min(value * 10 + (c - '0'), MAX_PARAM_VALUE);
+  }
+}
+
+InputEvent::Modifiers InputParser::get_key_modifiers() const {
+  // xterm encodes the modifiers as 1 + (shift | alt << 1 | ctrl << 2 | meta << 3) in the second parameter.
+  if (this->csi_param_count < 2 or this->csi_params[1] < 2 or this->csi_params[1] > 16) {
+    return InputEvent::NO_MODIFIERS;
+  }
+
+  auto const bits = this->csi_params[1] - 1;
+  auto key_modifiers = bits & 1 ? InputEvent::SHIFT_DOWN : InputEvent::NO_MODIFIERS;
+  key_modifiers |= bits & 2 ? InputEvent::ALT_DOWN : InputEvent::NO_MODIFIERS;
+  key_modifiers |= bits & 4 ? InputEvent::CTRL_DOWN : InputEvent::NO_MODIFIERS;
+  key_modifiers |= bits & 8 ? InputEvent::META_DOWN : InputEvent::NO_MODIFIERS;
+  return key_modifiers;
+}
+
+void InputParser::csi_dispatch(char c) {
+  // Replies, "?" for the modes and DA1, "$" for DECRPM, that came in too late for Terminal::parse_replies().
+  if (this->csi_intermediate != 0) {
+    return;
+  }
+
+  switch (this->csi_marker) {
+  case 0:
+    if (c == 'M' or c == 'm') {
+      mouse_dispatch(c == 'M');
+    } else {
+      csi_key_dispatch(c);
+    }
+    break;
+
+  case '<':
+    if (c == 'M' or c == 'm') {
+      mouse_dispatch(c == 'M');
+    }
+    break;
+
+  case '?':
+    if (c == 'c') { // DA1, the last of the replies
+      this->string_replies_expected = 0;
+    }
+    break;
+  }
+}
+
+void InputParser::csi_key_dispatch(char c) {
+  switch (c) {
+  case 'A':
+    this->listener.new_key_event(KeyEvent::VK_UP, get_key_modifiers());
+    break;
+  case 'B':
+    this->listener.new_key_event(KeyEvent::VK_DOWN, get_key_modifiers());
+    break;
+  case 'C':
+    this->listener.new_key_event(KeyEvent::VK_RIGHT, get_key_modifiers());
+    break;
+  case 'D':
+    this->listener.new_key_event(KeyEvent::VK_LEFT, get_key_modifiers());
+    break;
+  case 'H':
+    this->listener.new_key_event(KeyEvent::VK_HOME, get_key_modifiers());
+    break;
+  case 'F':
+    this->listener.new_key_event(KeyEvent::VK_END, get_key_modifiers());
+    break;
+  case 'Z':
+    this->listener.new_key_event(KeyEvent::VK_BACK_TAB, InputEvent::NO_MODIFIERS);
+    break;
+
+  case '~':
+    switch (this->csi_params[0]) {
+    case PASTE_START:
+      this->state = State::PASTE;
+      this->paste_scanned = 0;
+      break;
+    case 1:
+      //this->listener.new_key_event(KeyEvent::VK_FIND, get_key_modifiers());
+      break;
+    case 2:
+      this->listener.new_key_event(KeyEvent::VK_INSERT, get_key_modifiers());
+      break;
+    case 3:
+      this->listener.new_key_event(KeyEvent::VK_DELETE, get_key_modifiers());
+      break;
+    case 4:
+      //this->listener.new_key_event(KeyEvent::VK_SELECT, get_key_modifiers());
+      break;
+    case 5:
+      this->listener.new_key_event(KeyEvent::VK_PAGE_UP, get_key_modifiers());
+      break;
+    case 6:
+      this->listener.new_key_event(KeyEvent::VK_PAGE_DOWN, get_key_modifiers());
+      break;
+    case 15:
+      this->listener.new_key_event(KeyEvent::VK_F5, get_key_modifiers());
+      break;
+    case 17:
+      this->listener.new_key_event(KeyEvent::VK_F6, get_key_modifiers());
+      break;
+    case 18:
+      this->listener.new_key_event(KeyEvent::VK_F7, get_key_modifiers());
+      break;
+    case 19:
+      this->listener.new_key_event(KeyEvent::VK_F8, get_key_modifiers());
+      break;
+    case 20:
+      this->listener.new_key_event(KeyEvent::VK_F9, get_key_modifiers());
+      break;
+    case 21:
+      this->listener.new_key_event(KeyEvent::VK_F10, get_key_modifiers());
+      break;
+    case 23:
+      this->listener.new_key_event(KeyEvent::VK_F11, get_key_modifiers());
+      break;
+    case 24:
+      this->listener.new_key_event(KeyEvent::VK_F12, get_key_modifiers());
+      break;
+    case 28:
+      //this->listener.new_key_event(KeyEvent::VK_HELP, get_key_modifiers());
+      break;
+    case 29:
+      //this->listener.new_key_event(KeyEvent::VK_MENU, get_key_modifiers());
+      break;
+    }
+    break;
+  }
+}
+
+void InputParser::mouse_dispatch(bool pressed) {
+  if (this->csi_param_count < 3) {
+    return;
+  }
+
+  auto const flags = this->csi_params[0];
+  auto const button = flags & 3;
+  auto key_modifiers = flags & 4 ? InputEvent::SHIFT_DOWN : InputEvent::NO_MODIFIERS;
+  key_modifiers |= flags & 8 ? InputEvent::META_DOWN : InputEvent::NO_MODIFIERS;
+  key_modifiers |= flags & 16 ? InputEvent::CTRL_DOWN : InputEvent::NO_MODIFIERS;
+  auto const x = int(this->csi_params[1]) - 1;
+  auto const y = int(this->csi_params[2]) - 1;
+  if (flags & 64) {
+    this->listener.new_mouse_wheel_event(button == 0 ? -1 : 1, key_modifiers, x, y);
+  } else {
+    auto type = pressed ? MousePressEvent::MOUSE_PRESSED : MousePressEvent::MOUSE_RELEASED;
+    this->listener.new_mouse_event(type, MousePressEvent::Button(button), key_modifiers, x, y);
+  }
+}
+
+}
@@ -1,3 +1,4 @@
+#include <cstdlib>
 #include <iostream>
 
 #include <tui++/Window.h>
@@ -39,32 +40,17 @@ Terminal::Singleton::~Singleton() {
 }
 
 template<typename P, typename ...Params>
-static void print_ocs(const P &param, const Params &... params) {
-  std::cout << "\x1b]"sv << param;
+static void print_ocs(Terminal &terminal, const P &param, const Params &... params) {
+  terminal << "\x1b]"sv << param;
 
-  [[maybe_unused]] auto add_param = [](const auto &param) {
-    std::cout << ';' << param;
+  [[maybe_unused]] auto add_param = [&terminal](const auto &param) {
+    terminal << ';' << param;
   };
 
   (add_param(params),...);
   // https://learn.microsoft.com/en-us/windows/console/console-virtual-terminal-sequences:
   // BEL (0x7) may be used instead as the terminator, but the longer form is preferred.
-  std::cout << "\x1b\\"sv;
-}
-
-void Terminal::InputParser::new_mouse_event(bool pressed) {
-  auto button = this->csi_params[0] & 3;
-  auto key_modifiers = this->csi_params[0] & 4 ? InputEvent::SHIFT_DOWN : InputEvent::NO_MODIFIERS;
-  key_modifiers |= this->csi_params[0] & 8 ? InputEvent::META_DOWN : InputEvent::NO_MODIFIERS;
-  key_modifiers |= this->csi_params[0] & 16 ? InputEvent::CTRL_DOWN : InputEvent::NO_MODIFIERS;
-  auto x = this->csi_params[1] - 1;
-  auto y = this->csi_params[2] - 1;
-  if (this->csi_params[0] & 64) {
-    this->terminal.new_mouse_wheel_event(button == 0 ? -1 : 1, key_modifiers, x, y);
-  } else {
-    auto type = pressed ? MousePressEvent::MOUSE_PRESSED : MousePressEvent::MOUSE_RELEASED;
-    this->terminal.new_mouse_event(type, MousePressEvent::Button(button), key_modifiers, x, y);
-  }
+  terminal << "\x1b\\"sv;
 }
 
 void Terminal::hide_cursor() {
@@ -74,53 +60,57 @@ void Terminal::hide_cursor() {
 void Terminal::show_cursor(std::optional<Cursor> const &cursor) {
   set_option(DECModeOption::CURSOR);
   if (cursor) {
-    std::cout << "\x1b["sv << int(cursor->type()) << " q"sv;
+    *this << "\x1b["sv << int(cursor->type()) << " q"sv;
   }
 }
 
 void Terminal::set_option(Option option) {
   struct SetOption {
+    Terminal &terminal;
+
     void operator()(const DECModeOption &option) {
-      std::cout << "\x1b[?"sv << int(option) << 'h';
+      terminal << "\x1b[?"sv << int(option) << 'h';
     }
     void operator()(const ModifyKeyboardOption &option) {
-      std::cout << "\x1b[>0;"sv << int(option) << 'm';
+      terminal << "\x1b[>0;"sv << int(option) << 'm';
     }
     void operator()(const ModifyCursorKeysOption &option) {
-      std::cout << "\x1b[>1;"sv << int(option) << 'm';
+      terminal << "\x1b[>1;"sv << int(option) << 'm';
     }
     void operator()(const ModifyFunctionKeysOption &option) {
-      std::cout << "\x1b[>2;"sv << int(option) << 'm';
+      terminal << "\x1b[>2;"sv << int(option) << 'm';
     }
     void operator()(const ModifyOtherKeysOption &option) {
-      std::cout << "\x1b[>4;"sv << int(option) << 'm';
+      terminal << "\x1b[>4;"sv << int(option) << 'm';
     }
   };
 
-  std::visit(SetOption { }, option);
+  std::visit(SetOption { *this }, option);
   set_options.emplace_back(option);
 }
 
 void Terminal::reset_option(Option option) {
   struct ResetOption {
+    Terminal &terminal;
+
     void operator()(const DECModeOption &option) {
-      std::cout << "\x1b[?"sv << int(option) << 'l';
+      terminal << "\x1b[?"sv << int(option) << 'l';
     }
     void operator()(const ModifyKeyboardOption&) {
-      std::cout << "\x1b[>0m"sv;
+      terminal << "\x1b[>0m"sv;
     }
     void operator()(const ModifyCursorKeysOption&) {
-      std::cout << "\x1b[>1m"sv;
+      terminal << "\x1b[>1m"sv;
     }
     void operator()(const ModifyFunctionKeysOption&) {
-      std::cout << "\x1b[>2m"sv;
+      terminal << "\x1b[>2m"sv;
     }
     void operator()(const ModifyOtherKeysOption&) {
-      std::cout << "\x1b[>4m"sv;
+      terminal << "\x1b[>4m"sv;
     }
   };
 
-  std::visit(ResetOption { }, option);
+  std::visit(ResetOption { *this }, option);
 
   set_options.erase( //
       std::remove(set_options.begin(), set_options.end(), option), //
@@ -130,12 +120,17 @@ void Terminal::reset_option(Option option) {
 void Terminal::init() {
   std::ios_base::sync_with_stdio(false);
 
+  detect_capabilities();
+
   set_option(DECModeOption::USE_ALTERNATE_SCREEN_BUFFER);
   reset_option(DECModeOption::LINE_WRAP);
   set_option(DECModeOption::MOUSE_VT200);
   set_option(DECModeOption::MOUSE_ANY_EVENT);
-  set_option(DECModeOption::MOUSE_URXVT_EXT_MODE);
+  if (not this->capabilities.sgr_mouse) {
+    set_option(DECModeOption::MOUSE_URXVT_EXT_MODE);
+  }
   set_option(DECModeOption::MOUSE_SGR_EXT_MODE);
+  set_option(DECModeOption::BRACKETED_PASTE);
 
   hide_cursor();
 
@@ -143,6 +138,7 @@ void Terminal::init() {
 }
 
 void Terminal::deinit() {
+  reset_option(DECModeOption::BRACKETED_PASTE);
   reset_option(DECModeOption::MOUSE_SGR_EXT_MODE);
   reset_option(DECModeOption::MOUSE_URXVT_EXT_MODE);
   reset_option(DECModeOption::MOUSE_ANY_EVENT);
@@ -152,20 +148,167 @@ void Terminal::deinit() {
   flush();
 }
 
+void Terminal::detect_capabilities() {
+  auto getenv = [](const char *name) {
+    auto value = std::getenv(name);
+    return std::string_view(value ? value : "");
+  };
+  auto term = getenv("TERM"), colorterm = getenv("COLORTERM");
+
+  if (colorterm == "truecolor"sv or colorterm == "24bit"sv or term.ends_with("-direct"sv)) {
+    this->capabilities.color_depth = ColorDepth::TRUE_COLOR;
+  } else if (term.find("256color"sv) != term.npos) {
+    this->capabilities.color_depth = ColorDepth::PALETTE256;
+  }
+#ifdef _WIN32
+  // The console renders 24-bit colors ever since it processes VT sequences.
+  this->capabilities.color_depth = ColorDepth::TRUE_COLOR;
+#endif
+
+  // Terminals known to implement REP. Apple's Terminal claims to be xterm but does not.
+  for (auto &&name : { "xterm"sv, "foot"sv, "alacritty"sv, "wezterm"sv, "contour"sv }) {
+    if (term.starts_with(name)) {
+      this->capabilities.repeat_char = getenv("TERM_PROGRAM") != "Apple_Terminal"sv;
+    }
+  }
+
+  // Ask for the modes and for the RGB capability, with DA1 last as every terminal answers it.
+  *this << "\x1b[?"sv << unsigned(DECModeOption::SYNCHRONIZED_OUTPUT) << "$p"sv;
+  *this << "\x1b[?"sv << unsigned(DECModeOption::MOUSE_SGR_EXT_MODE) << "$p"sv;
+  *this << "\x1b[?u"sv;
+  *this << "\x1bP+q524742\x1b\\"sv;
+  *this << "\x1b[c"sv;
+  flush();
+  if (not parse_replies(this->capabilities_detection_timeout)) {
+    // The XTGETTCAP reply may still come, and is not to be read as Alt+P and the keys that follow.
+    this->input_parser.expect_string_reply();
+  }
+}
+
+bool Terminal::parse_replies(const std::chrono::milliseconds &timeout) {
+  auto const deadline = Clock::now() + timeout;
+  // Every terminal replies to DA1, in order, so its reply comes after the others.
+  auto device_attributes = false;
+  while (not device_attributes) {
+    auto const now = Clock::now();
+    if (now >= deadline or not read_input(std::chrono::ceil<std::chrono::milliseconds>(deadline - now), this->input_buffer)) {
+      break;
+    }
+
+    auto input = this->input_buffer.get_input();
+    for (auto i = input.find('\x1b'); i < input.size(); i = input.find('\x1b', i)) {
+      if (auto size = parse_reply(input.substr(i), device_attributes)) {
+        this->input_buffer.remove(i, size);
+        input = this->input_buffer.get_input();
+      } else {
+        i += 1;
+      }
+    }
+  }
+  return device_attributes;
+}
+
+/**
+ * @return the size of the reply input starts with, 0 if it does not start with a complete one
+ */
+size_t Terminal::parse_reply(std::string_view input, bool &device_attributes) {
+  if (input.starts_with("\x1b[?"sv)) {
+    unsigned params[2] = { };
+    auto param = 0U;
+    for (auto i = size_t(3); i < input.size(); ++i) {
+      auto const c = input[i];
+      if (std::isdigit(c)) {
+        if (param < std::size(params)) {
+          params[param] = params[param] * 10 + (c - '0');
+        }
+        continue;
+      }
+
+      switch (c) {
+      case ';':
+        param += 1;
+        break;
+      case '$':
+        break;
+
+      case 'c': // DA1
+        device_attributes = true;
+        return i + 1;
+      case 'u': // the kitty keyboard protocol flags
+        this->capabilities.kitty_keyboard = true;
+        return i + 1;
+      case 'y': { // DECRPM, 0 if the mode is unknown, 4 if it is permanently reset
+        auto const supported = params[1] >= 1 and params[1] <= 3;
+        if (params[0] == unsigned(DECModeOption::SYNCHRONIZED_OUTPUT)) {
+          this->capabilities.synchronized_output = supported;
+        } else if (params[0] == unsigned(DECModeOption::MOUSE_SGR_EXT_MODE)) {
+          this->capabilities.sgr_mouse = supported;
+        }
+        return i + 1;
+      }
+
+      default:
+        return 0;
+      }
+    }
+  } else if (input.starts_with("\x1bP"sv)) {
+    auto end = input.find("\x1b\\"sv);
+    if (end == input.npos) {
+      return 0;
+    }
+    // XTGETTCAP, "1+r" and the hex encoded name of a capability the terminal has.
+    if (input.substr(2, end - 2).starts_with("1+r524742"sv)) { // RGB
+      this->capabilities.color_depth = ColorDepth::TRUE_COLOR;
+    }
+    return end + 2;
+  }
+  return 0;
+}
+
+void Terminal::read_events(const std::chrono::milliseconds &timeout) {
+  auto const pending = this->input_parser.is_escape_pending() or this->input_parser.is_paste_pending();
+  auto const pending_timeout = this->input_parser.is_paste_pending() ? this->paste_timeout : this->escape_timeout;
+  // Keys typed while the capabilities were detected are left in the buffer, they are not to wait for more input.
+  auto const buffered = this->input_buffer.get_available() != 0 and not this->input_parser.is_paste_pending();
+  auto wait = buffered ? std::chrono::milliseconds::zero() : timeout;
+  if (pending) {
+    wait = std::min(wait, std::chrono::ceil<std::chrono::milliseconds>(this->input_time + pending_timeout - Clock::now()));
+    wait = std::max(wait, std::chrono::milliseconds::zero());
+  }
+
+  // Whatever one read brings in is parsed at once, along with what was buffered.
+  if (read_input(wait, this->input_buffer) or buffered) {
+    // An unfinished paste stays in the buffer, to be handed over in one piece once the rest of it is read.
+    this->input_buffer.skip(this->input_parser.parse(this->input_buffer.get_input()));
+    post_pending_mouse_motion();
+    this->input_time = Clock::now();
+  } else if (pending and Clock::now() - this->input_time >= pending_timeout) {
+    // A paste whose end did not come in time ends with what came of it, rather than swallow the keys typed after it.
+    this->input_buffer.skip(this->input_parser.flush(this->input_buffer.get_input()));
+  }
+
+  if (std::exchange(this->resize_pending, false)) {
+    terminal_screen.terminal_resized();
+  }
+}
+
 void Terminal::set_title(const std::string &title) {
-  print_ocs('0', title);
+  print_ocs(*this, '0', title);
   flush();
 }
 
 void Terminal::new_resize_event() {
-  terminal_screen.terminal_resized();
+  // Input is read by init() too, before terminal_screen is constructed, so the resize is left to read_events().
+  this->resize_pending = true;
 }
 
 void Terminal::new_key_event(const Char &c, InputEvent::Modifiers key_modifiers) {
+  post_pending_mouse_motion();
   terminal_screen.post_system<KeyEvent>(KeyboardFocusManager::single->get_focused_window(), c, key_modifiers);
 }
 
 void Terminal::new_key_event(KeyEvent::KeyCode key_code, InputEvent::Modifiers key_modifiers) {
+  post_pending_mouse_motion();
   terminal_screen.post_system<KeyEvent>(KeyboardFocusManager::single->get_focused_window(), KeyEvent::KEY_PRESSED, key_code, key_modifiers);
 }
 
@@ -197,12 +340,17 @@ void Terminal::new_mouse_event(MousePressEvent::Type type, MousePressEvent::Butt
   }
 
   if (motion) {
-    if (type == MousePressEvent::MOUSE_PRESSED and button != MousePressEvent::NO_BUTTON) {
-      terminal_screen.post_system<MouseDragEvent>(window, button, modifiers, p.x, p.y);
+    auto const dragged_button = type == MousePressEvent::MOUSE_PRESSED ? button : MousePressEvent::NO_BUTTON;
+    auto &pending = this->pending_mouse_motion;
+    if (pending and pending->window == window and pending->button == dragged_button and pending->modifiers == modifiers) {
+      pending->p = p;
+      this->coalesced_mouse_motion_count += 1;
     } else {
-      terminal_screen.post_system<MouseMoveEvent>(window, modifiers, p.x, p.y);
+      post_pending_mouse_motion();
+      pending = MouseMotion { window, dragged_button, modifiers, p };
     }
   } else {
+    post_pending_mouse_motion();
     terminal_screen.post_system<MousePressEvent>(window, type, button, modifiers, p.x, p.y, false);
 
     if (type == MousePressEvent::MOUSE_PRESSED) {
@@ -228,6 +376,8 @@ void Terminal::new_mouse_event(MousePressEvent::Type type, MousePressEvent::Butt
 }
 
 void Terminal::new_mouse_wheel_event(int wheel_rotation, InputEvent::Modifiers key_modifiers, int x, int y) {
+  post_pending_mouse_motion();
+
   auto p = Point { x, y };
 
   auto window = terminal_screen.get_window_at(p);
@@ -238,17 +388,39 @@ void Terminal::new_mouse_wheel_event(int wheel_rotation, InputEvent::Modifiers k
   terminal_screen.post_system<MouseWheelEvent>(window, key_modifiers, p.x, p.y, wheel_rotation);
 }
 
-TerminalScreen& Terminal::get_screen() {
-  return terminal_screen;
+void Terminal::new_paste_event(std::string_view text) {
+  post_pending_mouse_motion();
+  // The text goes to the component that has the focus, the focused window itself if none in it has.
+  auto target = KeyboardFocusManager::single->get_focus_owner();
+  if (not target) {
+    target = KeyboardFocusManager::single->get_focused_window();
+  }
+  // The input buffer is reused by the next read, so the event keeps a copy of the text.
+  terminal_screen.post_system<PasteEvent>(target, std::string(text));
+}
+
+void Terminal::post_pending_mouse_motion() {
+  if (auto &motion = this->pending_mouse_motion) {
+    if (motion->button != MousePressEvent::NO_BUTTON) {
+      terminal_screen.post_system<MouseDragEvent>(motion->window, motion->button, motion->modifiers, motion->p.x, motion->p.y);
+    } else {
+      terminal_screen.post_system<MouseMoveEvent>(motion->window, motion->modifiers, motion->p.x, motion->p.y);
+    }
+    motion.reset();
+  }
 }
 
-Terminal& Terminal::write(const char *data, size_t size) {
-  std::cout.write(data, size);
-  return *this;
+TerminalScreen& Terminal::get_screen() {
+  return terminal_screen;
 }
 
 void Terminal::flush() {
-  std::cout << std::flush;
+  this->last_flush_size = this->output_buffer.size();
+  if (not this->output_buffer.empty()) {
+    write_output(this->output_buffer.data(), this->output_buffer.size());
+    this->total_bytes_written += this->output_buffer.size();
+    this->output_buffer.clear();
+  }
 }
 
 Terminal& operator<<(Terminal &term, std::string_view const &value) {
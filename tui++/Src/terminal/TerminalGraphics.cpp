@@ -97,10 +97,8 @@ void TerminalGraphics::draw_rect(int x, int y, int width, int height, const BoxC
       // top left corner
       this->screen.draw_char(chars.top_left, left, top, this->foreground_color, this->background_color, this->attributes);
     }
-    for (int i = max_left + 1; i < min_right - 1; i++) {
-      // top horizontal line
-      this->screen.draw_char(chars.top, i, top, this->foreground_color, this->background_color, this->attributes);
-    }
+    // top horizontal line
+    this->screen.fill_rect(chars.top, { max_left + 1, top, min_right - 1 - (max_left + 1), 1 }, this->foreground_color, this->background_color, this->attributes);
     if (right == min_right) {
       // top right corner
       this->screen.draw_char(chars.top_right, right - 1, top, this->foreground_color, this->background_color, this->attributes);
@@ -113,10 +111,8 @@ void TerminalGraphics::draw_rect(int x, int y, int width, int height, const BoxC
       // bottom left corner
       this->screen.draw_char(chars.bottom_left, left, bottom - 1, this->foreground_color, this->background_color, this->attributes);
     }
-    for (int i = max_left + 1; i < min_right - 1; i++) {
-      // bottom horizontal line
-      this->screen.draw_char(chars.bottom, i, bottom - 1, this->foreground_color, this->background_color, this->attributes);
-    }
+    // bottom horizontal line
+    this->screen.fill_rect(chars.bottom, { max_left + 1, bottom - 1, min_right - 1 - (max_left + 1), 1 }, this->foreground_color, this->background_color, this->attributes);
     if (right == min_right) {
       // bottom right corner
       this->screen.draw_char(chars.bottom_right, right - 1, bottom - 1, this->foreground_color, this->background_color, this->attributes);
@@ -125,16 +121,12 @@ void TerminalGraphics::draw_rect(int x, int y, int width, int height, const BoxC
 
   // If the left side of the box is outside the clipping rectangle, don't bother.
   if (left >= clip_left and left < clip_right) {
-    for (int i = max_top + 1; i < min_bottom - 1; i++) {
-      this->screen.draw_char(chars.left, left, i, this->foreground_color, this->background_color, this->attributes);
-    }
+    this->screen.fill_rect(chars.left, { left, max_top + 1, 1, min_bottom - 1 - (max_top + 1) }, this->foreground_color, this->background_color, this->attributes);
   }
   //
   // If the right side of the box is outside the clipping rectangle, don't bother.
   if (right >= clip_left and right <= clip_right) {
-    for (int i = max_top + 1; i < min_bottom - 1; i++) {
-      this->screen.draw_char(chars.right, right - 1, i, this->foreground_color, this->background_color, this->attributes);
-    }
+    this->screen.fill_rect(chars.right, { right - 1, max_top + 1, 1, min_bottom - 1 - (max_top + 1) }, this->foreground_color, this->background_color, this->attributes);
   }
 }
 
@@ -145,9 +137,9 @@ void TerminalGraphics::clip_rect(int x, int y, int width, int height) {
   int bottom = top + height;
 
   int clip_left = std::max(this->clip.x, left);
-  int clip_right = std::min(clip_left + this->clip.width, right);
+  int clip_right = std::min(this->clip.x + this->clip.width, right);
   int clip_top = std::max(this->clip.y, top);
-  int clip_bottom = std::min(clip_top + this->clip.height, bottom);
+  int clip_bottom = std::min(this->clip.y + this->clip.height, bottom);
 
   int clip_width = clip_right - clip_left;
   int clip_height = clip_bottom - clip_top;
@@ -156,7 +148,7 @@ void TerminalGraphics::clip_rect(int x, int y, int width, int height) {
 }
 
 std::unique_ptr<Graphics> TerminalGraphics::create() {
-  return std::make_unique<TerminalGraphics>(this->screen, this->clip, this->dx, this->dx);
+  return std::make_unique<TerminalGraphics>(this->screen, this->clip, this->dx, this->dy);
 }
 
 std::unique_ptr<Graphics> TerminalGraphics::create(int x, int y, int width, int height) {
@@ -166,6 +158,23 @@ std::unique_ptr<Graphics> TerminalGraphics::create(int x, int y, int width, int
   return g;
 }
 
+void TerminalGraphics::save() {
+  this->saved_states.emplace_back(this->font, this->dx, this->dy, this->clip, this->stroke, this->foreground_color, this->background_color, this->attributes);
+}
+
+void TerminalGraphics::restore() {
+  auto &state = this->saved_states.back();
+  this->font = state.font;
+  this->dx = state.dx;
+  this->dy = state.dy;
+  this->clip = state.clip;
+  this->stroke = state.stroke;
+  this->foreground_color = state.foreground_color;
+  this->background_color = state.background_color;
+  this->attributes = state.attributes;
+  this->saved_states.pop_back();
+}
+
 void TerminalGraphics::draw_char(const Char &c, int x, int y, std::optional<Attributes> const &attributes) {
   if (this->clip.contains(x + this->dx, y + this->dy)) {
     this->screen.draw_char(c, x + this->dx, y + this->dy, this->foreground_color, this->background_color, this->attributes | attributes);
@@ -174,10 +183,7 @@ void TerminalGraphics::draw_char(const Char &c, int x, int y, std::optional<Attr
 
 void TerminalGraphics::draw_hline(int x, int y, int length, std::optional<Attributes> const &attributes) {
   if (auto const rect = this->clip.intersection(x + this->dx, y + this->dy, length, 1)) {
-    auto &chars = get_box_chars(this->stroke);
-    for (int x = rect.left(), right = rect.right(); x < right; ++x) {
-      this->screen.draw_char(chars.horizontal, x, rect.y, this->foreground_color, this->background_color, this->attributes | attributes);
-    }
+    this->screen.fill_rect(get_box_chars(this->stroke).horizontal, rect, this->foreground_color, this->background_color, this->attributes | attributes);
   }
 }
 
@@ -192,37 +198,35 @@ void TerminalGraphics::draw_rounded_rect(int x, int y, int width, int height) {
 void TerminalGraphics::draw_string(const std::string &str, int x, int y, std::optional<Attributes> const &attributes) {
   x += this->dx;
   y += this->dy;
-  if (auto const rect = this->clip.intersection(x, y, util::glyph_width(str), 1)) {
-    auto const left = rect.left(), right = rect.right();
+  if (y >= this->clip.top() and y < this->clip.bottom()) {
+    auto const left = this->clip.left(), right = this->clip.right();
     for (auto &&ch : to_chars(str)) {
-      auto glyph_width = ch.glyph_width();
-      if ((x + glyph_width) >= left) {
-        this->screen.draw_char(ch, x, y, this->foreground_color, this->background_color, this->attributes | attributes);
-      }
-      x += glyph_width;
+      // Look the width up once, the screen caches it in the cell.
+      auto glyph_width = std::max(ch.glyph_width(), 0);
       if (x >= right) {
         break;
+      } else if (x >= left and x + glyph_width <= right) {
+        this->screen.draw_char(ch, glyph_width, x, y, this->foreground_color, this->background_color, this->attributes | attributes);
+      } else if (x + glyph_width > left) {
+        // A wide glyph cut by the clip, the half inside it is blanked rather than left showing what was there.
+        for (auto i = std::max(x, left); i < std::min(x + glyph_width, right); ++i) {
+          this->screen.draw_char(' ', 1, i, y, this->foreground_color, this->background_color, this->attributes | attributes);
+        }
       }
+      x += glyph_width;
     }
   }
 }
 
 void TerminalGraphics::draw_vline(int x, int y, int length, std::optional<Attributes> const &attributes) {
   if (auto const rect = this->clip.intersection(x + this->dx, y + this->dy, 1, length)) {
-    auto &chars = get_box_chars(this->stroke);
-    for (auto y = rect.top(), bottom = rect.bottom(); y < bottom; ++y) {
-      this->screen.draw_char(chars.vertical, rect.x, y, this->foreground_color, this->background_color, this->attributes | attributes);
-    }
+    this->screen.fill_rect(get_box_chars(this->stroke).vertical, rect, this->foreground_color, this->background_color, this->attributes | attributes);
   }
 }
 
 void TerminalGraphics::fill_rect(int x, int y, int width, int height) {
   if (auto const rect = this->clip.intersection(x + this->dx, y + this->dy, width, height)) {
-    for (auto j = rect.top(), bottom = rect.bottom(); j < bottom; j++) {
-      for (auto i = rect.left(), right = rect.right(); i < right; i++) {
-        this->screen.draw_char(' ', i, j, this->foreground_color, this->background_color, this->attributes);
-      }
-    }
+    this->screen.fill_rect(' ', rect, this->foreground_color, this->background_color, this->attributes);
   }
 }
 
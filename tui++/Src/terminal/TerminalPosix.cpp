@@ -1,9 +1,12 @@
 #ifndef _WIN32
 
+#include <cerrno>
 #include <csignal>
 
+#include <fcntl.h>
+#include <poll.h>
+
 #include <sys/ioctl.h>
-#include <sys/select.h>
 
 #include <termios.h>
 #include <unistd.h>
@@ -14,12 +17,18 @@
 namespace tui {
 
 struct TerminalImpl {
+  constexpr static size_t MIN_READ_SIZE = 1024;
+
   static inline TerminalImpl *impl = nullptr;
+  static inline volatile std::sig_atomic_t resize_pending = 0;
   Terminal &terminal;
 
   struct ::termios termios;
   //int input_flags;
 
+  // Self-pipe used to interrupt poll() in read_input() from other threads and from the signal handler.
+  int wakeup_pipe[2] = { -1, -1 };
+
 public:
   TerminalImpl(Terminal &terminal) :
       terminal(terminal) {
@@ -34,41 +43,100 @@ public:
     //this->input_flags = ::fcntl(STDIN_FILENO, F_GETFL, 0);
     //::fcntl(STDIN_FILENO, F_SETFL, this->input_flags | O_NONBLOCK);
 
+    if (::pipe(this->wakeup_pipe) == 0) {
+      for (auto fd : this->wakeup_pipe) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+      }
+    }
+
     std::signal(SIGWINCH, signal_handler);
   }
 
-  bool is_stdin_empty(const std::chrono::microseconds &timeout) {
-    fd_set fds;
-    FD_ZERO(&fds);
-    FD_SET(STDIN_FILENO, &fds);
-    timeval tv = {0, timeout.count()};
-    ::select(STDIN_FILENO + 1, &fds, nullptr, nullptr, &tv);
-    return not FD_ISSET(STDIN_FILENO, &fds);
+  /**
+   * Waits for stdin to become readable or for a wakeup(), whichever comes first.
+   *
+   * @return true iff stdin is readable
+   */
+  bool wait_input(const std::chrono::milliseconds &timeout) {
+    pollfd fds[] = { { STDIN_FILENO, POLLIN, 0 }, { this->wakeup_pipe[0], POLLIN, 0 } };
+    auto poll_timeout = timeout == std::chrono::milliseconds::max() ? -1 : int(timeout.count());
+    if (::poll(fds, std::size(fds), poll_timeout) <= 0) {
+      return false; // timeout or EINTR
+    }
+    if (fds[1].revents & POLLIN) {
+      char drain[64];
+      while (::read(this->wakeup_pipe[0], drain, sizeof(drain)) > 0) {
+      }
+      // Any number of SIGWINCHs since the last check result in one resize to the latest size.
+      if (resize_pending) {
+        resize_pending = 0;
+        this->terminal.new_resize_event();
+      }
+    }
+    return fds[0].revents & (POLLIN | POLLHUP);
+  }
+
+  void wakeup() {
+    char c = 0;
+    [[maybe_unused]] auto written = ::write(this->wakeup_pipe[1], &c, 1); // EAGAIN means a wakeup is already pending
   }
 
   bool read_input(const std::chrono::milliseconds &timeout, Terminal::InputBuffer &into) {
-    if (not is_stdin_empty(timeout)) {
-      auto byte = '\0';
-      if ((::read(fileno(stdin), &byte, 1) == 1)) {
-        into.put(byte);
+    if (wait_input(timeout)) {
+      // Drain everything that is available at once, a paste or a burst of mouse reports may be many kilobytes.
+      auto available = 0;
+      if (::ioctl(STDIN_FILENO, FIONREAD, &available) < 0 or available < int(MIN_READ_SIZE)) {
+        available = MIN_READ_SIZE;
+      }
+      auto *data = into.reserve(available);
+      if (auto size = ::read(STDIN_FILENO, data, into.get_free()); size > 0) {
+        into.commit(size);
         return true;
       }
     }
     return false;
   }
 
+  bool write_output(const char *data, size_t size) {
+    while (size > 0) {
+      if (auto written = ::write(STDOUT_FILENO, data, size); written >= 0) {
+        data += written;
+        size -= written;
+      } else if (errno == EAGAIN or errno == EWOULDBLOCK) {
+        // stdout is non-blocking and the terminal is not keeping up, wait until it drains.
+        pollfd fd { STDOUT_FILENO, POLLOUT, 0 };
+        ::poll(&fd, 1, -1);
+      } else if (errno != EINTR) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   ~TerminalImpl() {
     //::fcntl(STDIN_FILENO, F_GETFL, this->input_flags);
 
     ::tcsetattr(STDIN_FILENO, TCSANOW, &this->termios);
+
+    for (auto fd : this->wakeup_pipe) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
   }
 
+  // Only async-signal-safe calls here, the resize itself is handled by the event loop, see wait_input().
   static void signal_handler(int signal) {
     switch(signal) {
-    case SIGWINCH:
-        impl->terminal.new_resize_event();
+    case SIGWINCH: {
+        auto saved_errno = errno;
+        resize_pending = 1;
+        impl->wakeup();
+        errno = saved_errno;
         break;
     }
+    }
   }
 };
 
@@ -85,6 +153,14 @@ bool Terminal::read_input(const std::chrono::milliseconds &timeout, InputBuffer
   return this->impl->read_input(timeout, into);
 }
 
+void Terminal::wakeup() {
+  this->impl->wakeup();
+}
+
+bool Terminal::write_output(const char *data, size_t size) {
+  return this->impl->write_output(data, size);
+}
+
 Dimension Terminal::get_size() {
   winsize w {};
   if (::ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) < 0 or w.ws_col == 0 or w.ws_row == 0) {
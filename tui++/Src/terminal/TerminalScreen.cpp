@@ -7,8 +7,17 @@
 
 #include <tui++/util/utf-8.h>
 
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
 #include <string_view>
 
+#if defined(__SSE2__) or defined(_M_X64) or defined(_M_AMD64)
+#include <emmintrin.h>
+#define TUI_SSE2
+#endif
+
 namespace tui::detail {
 Screen& get_screen() {
   return Terminal::get_singleton().get_screen();
@@ -19,99 +28,55 @@ using namespace std::string_view_literals;
 
 namespace tui {
 
-constexpr std::chrono::milliseconds WAIT_EVENT_TIMEOUT { 30 };
 
-static void escape_attrs(const Attributes &reset, const Attributes &set) {
-  if (reset or set) {
-    terminal << "\x1B["sv;
-    auto delim = false;
-    for (auto &&attr : reset) {
-      if (delim) {
-        terminal << ';';
-      }
-      switch (attr) {
-      case Attribute::INVERSE:
-      case Attribute::STANDOUT:
-        terminal << "27"sv;
-        break;
-      case Attribute::BOLD:
-      case Attribute::DIM:
-        terminal << "22"sv;
-        break;
-      case Attribute::ITALIC:
-        terminal << "23"sv;
-        break;
-      case Attribute::UNDERLINE:
-      case Attribute::DOUBLE_UNDERLINE:
-        terminal << "24"sv;
-        break;
-      case Attribute::BLINK:
-        terminal << "25"sv;
-        break;
-      case Attribute::INVISIBLE:
-        terminal << "28"sv;
-        break;
-      case Attribute::CROSSED_OUT:
-        terminal << "29"sv;
-        break;
+// The parameters of one SGR sequence, collected in place so that all the changes of a cell go out in a single CSI.
+class SgrParams {
+  std::array<char, 128> buffer;
+  size_t size = 0;
 
-      default:
-        delim = false;
-        continue;
-      }
-
-      delim = true;
-    }
-
-    for (auto &&attr : set) {
-      if (delim) {
-        terminal << ';';
-      }
-      switch (attr) {
-      case Attribute::STANDOUT:
-        terminal << "1;7"sv;
-        break;
-      case Attribute::BOLD:
-        terminal << '1';
-        break;
-      case Attribute::DIM:
-        terminal << '2';
-        break;
-      case Attribute::ITALIC:
-        terminal << '3';
-        break;
-      case Attribute::UNDERLINE:
-        terminal << '4';
-        break;
-      case Attribute::BLINK:
-        terminal << '5';
-        break;
-      case Attribute::INVERSE:
-        terminal << '7';
-        break;
-      case Attribute::INVISIBLE:
-        terminal << '8';
-        break;
-      case Attribute::CROSSED_OUT:
-        terminal << '9';
-        break;
-      case Attribute::DOUBLE_UNDERLINE:
-        terminal << "21"sv;
-        break;
-
-      default:
-        delim = false;
-        continue;
-      }
-
-      delim = true;
+public:
+  SgrParams& add(std::string_view param) {
+    if (this->size) {
+      this->buffer[this->size++] = ';';
     }
+    std::memcpy(this->buffer.data() + this->size, param.data(), param.size());
+    this->size += param.size();
+    return *this;
+  }
 
-    terminal << 'm';
+  SgrParams& add(unsigned param) {
+    char buf[4];
+    auto &&result = std::to_chars(buf, buf + std::size(buf), param);
+    return add(std::string_view(buf, result.ptr - buf));
   }
-}
 
-constexpr std::array<std::string_view, 33> palette16_color_codes = //
+  std::string_view view() const {
+    return { this->buffer.data(), this->size };
+  }
+};
+
+constexpr std::pair<Attribute, std::string_view> sgr_set_codes[] = { //
+    { Attribute::BOLD, "1" }, //
+    { Attribute::DIM, "2" }, //
+    { Attribute::ITALIC, "3" }, //
+    { Attribute::UNDERLINE, "4" }, //
+    { Attribute::BLINK, "5" }, //
+    { Attribute::INVERSE, "7" }, //
+    { Attribute::INVISIBLE, "8" }, //
+    { Attribute::CROSSED_OUT, "9" }, //
+    { Attribute::DOUBLE_UNDERLINE, "21" } };
+
+// A reset code turns off every attribute of its group.
+constexpr std::pair<Attributes, std::string_view> sgr_reset_codes[] = { //
+    { Attribute::BOLD | Attribute::DIM, "22" }, //
+    { Attribute::ITALIC, "23" }, //
+    { Attribute::UNDERLINE | Attribute::DOUBLE_UNDERLINE, "24" }, //
+    { Attribute::BLINK, "25" }, //
+    { Attribute::INVERSE, "27" }, //
+    { Attribute::INVISIBLE, "28" }, //
+    { Attribute::CROSSED_OUT, "29" } };
+
+constexpr std::array<std::string_view, 32> palette16_color_codes = //
     { "30", "40",   //
       "31", "41",   //
       "32", "42",   //
@@ -129,51 +94,146 @@ constexpr std::array<std::string_view, 33> palette16_color_codes = //
       "96", "106",  //
       "97", "107" };
 
-static void escape_background_color(TerminalColor const &color) {
-  struct SetBackgroundColor {
+// The attributes as the terminal sees them, STANDOUT being bold and inverse.
+static Attributes to_sgr(Attributes attributes) {
+  if (attributes & Attribute::STANDOUT) {
+    attributes = (attributes & ~Attributes(Attribute::STANDOUT)) | Attribute::BOLD | Attribute::INVERSE;
+  }
+  return attributes;
+}
+
+static void add_attributes(SgrParams &params, Attributes const &attributes) {
+  for (auto &&[attribute, code] : sgr_set_codes) {
+    if (attributes & attribute) {
+      params.add(code);
+    }
+  }
+}
+
+static void add_color(SgrParams &params, TerminalColor const &color, bool background) {
+  struct AddColor {
+    SgrParams &params;
+    bool background;
+
     void operator()(detail::DefaultColor const&) {
-      terminal << "\x1b[49m"sv;
+      this->params.add(this->background ? "49"sv : "39"sv);
     }
 
     void operator()(detail::Palette16Color const &c) {
-      terminal << "\x1b["sv << palette16_color_codes[2 * c.index + 1] << 'm';
+      this->params.add(palette16_color_codes[2 * c.index + this->background]);
     }
 
     void operator()(detail::Palette256Color const &c) {
-      terminal << "\x1b[48;5;"sv << c.index << 'm';
+      if (c.index < 16) {
+        // The first 256 palette colors are the 16 palette ones.
+        this->params.add(palette16_color_codes[2 * c.index + this->background]);
+      } else {
+        this->params.add(this->background ? "48;5"sv : "38;5"sv).add(c.index);
+      }
     }
 
     void operator()(detail::TrueColor const &c) {
-      terminal << "\x1b[48;2;"sv << c.red << ';' << c.green << ';' << c.blue << 'm';
+      this->params.add(this->background ? "48;2"sv : "38;2"sv).add(c.red).add(c.green).add(c.blue);
     }
   };
-  std::visit(SetBackgroundColor { }, color);
+  std::visit(AddColor { params, background }, color);
 }
 
-static void escape_foreground_color(TerminalColor const &color) {
-  struct SetForegroundColor {
-    void operator()(detail::DefaultColor const&) {
-      terminal << "\x1b[39m"sv;
-    }
+static size_t decimal_size(unsigned value) {
+  auto size = size_t(1);
+  for (; value >= 10; value /= 10) {
+    size += 1;
+  }
+  return size;
+}
 
-    void operator()(detail::Palette16Color const &c) {
-      terminal << "\x1b["sv << palette16_color_codes[2 * c.index] << 'm';
+/**
+ * Switches the terminal from the attributes and colors of one cell to those of another in a single SGR sequence, using
+ * either the individual resets or a full reset, whichever is shorter.
+ */
+template<typename Cell>
+static void escape_sgr(const Cell &from, const Cell &to) {
+  auto const from_attributes = to_sgr(from.attributes), to_attributes = to_sgr(to.attributes);
+
+  SgrParams changes;
+  auto attributes = from_attributes;
+  for (auto &&[group, code] : sgr_reset_codes) {
+    if (attributes & group & ~to_attributes) {
+      changes.add(code);
+      attributes &= ~group;
     }
+  }
+  add_attributes(changes, to_attributes & ~attributes);
+  if (from.foreground_color != to.foreground_color) {
+    add_color(changes, to.foreground_color, false);
+  }
+  if (from.background_color != to.background_color) {
+    add_color(changes, to.background_color, true);
+  }
 
-    void operator()(detail::Palette256Color const &c) {
-      terminal << "\x1b[38;5;"sv << c.index << 'm';
-    }
+  SgrParams reset;
+  reset.add("0"sv);
+  add_attributes(reset, to_attributes);
+  if (to.foreground_color != PackedTerminalColor { }) {
+    add_color(reset, to.foreground_color, false);
+  }
+  if (to.background_color != PackedTerminalColor { }) {
+    add_color(reset, to.background_color, true);
+  }
 
-    void operator()(detail::TrueColor const &c) {
-      terminal << "\x1b[38;2;"sv << c.red << ';' << c.green << ';' << c.blue << 'm';
-    }
-  };
-  std::visit(SetForegroundColor { }, color);
+  auto const params = reset.view().size() < changes.view().size() ? reset.view() : changes.view();
+  if (not params.empty()) {
+    terminal << "\x1b["sv << params << 'm';
+  }
 }
 
 TerminalScreen::CharView TerminalScreen::EMPTY_CHAR_VIEW;
 
+/**
+ * Returns the first column in [from, to) where the rows differ, or to if there is none.
+ *
+ * Cells have no padding, so they are compared as plain memory. With SSE2 the rows are scanned four cells, 64 bytes, per
+ * iteration, the cell that differs and the cells past the last four are then found one at a time.
+ */
+template<typename Cell>
+static int find_mismatch(const Cell *row, const Cell *front_row, int from, int to) {
+  static_assert(sizeof(Cell) == 16);
+  auto x = from;
+#ifdef TUI_SSE2
+  for (; x + 4 <= to; x += 4) {
+    auto const a = reinterpret_cast<const __m128i*>(row + x), b = reinterpret_cast<const __m128i*>(front_row + x);
+    auto const equal01 = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128(a), _mm_loadu_si128(b)), _mm_cmpeq_epi8(_mm_loadu_si128(a + 1), _mm_loadu_si128(b + 1)));
+    auto const equal23 = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128(a + 2), _mm_loadu_si128(b + 2)), _mm_cmpeq_epi8(_mm_loadu_si128(a + 3), _mm_loadu_si128(b + 3)));
+    if (_mm_movemask_epi8(_mm_and_si128(equal01, equal23)) != 0xFFFF) {
+      break;
+    }
+  }
+#endif
+  for (; x < to; ++x) {
+    if (std::memcmp(row + x, front_row + x, sizeof(Cell)) != 0) {
+      return x;
+    }
+  }
+  return to;
+}
+
+template<typename Cell>
+static uint64_t hash_row(const Cell *row, int width) {
+  auto hash = uint64_t(0xCBF29CE484222325);
+  for (auto &&cell : std::span(row, width)) {
+    uint64_t words[2];
+    std::memcpy(words, &cell, sizeof(words));
+    hash = (hash ^ words[0]) * 0x100000001B3;
+    hash = (hash ^ words[1]) * 0x100000001B3;
+  }
+  return hash;
+}
+
 TerminalScreen::TerminalScreen() noexcept {
+  // Events posted from other threads must wake the event loop up while it sleeps in the terminal input wait.
+  this->event_queue.set_wakeup_handler([] {
+    terminal.wakeup();
+  });
   laf::LookAndFeel::set_theme(std::make_shared<TerminalTheme>());
   resize_view();
 }
@@ -200,9 +260,25 @@ void TerminalScreen::run_event_loop() {
   event_dispatching_thread_id = std::this_thread::get_id();
 
   while (not this->quit) {
-    terminal.read_events();
-    if (auto event = this->event_queue.pop(WAIT_EVENT_TIMEOUT)) {
+    // Sleep until there is terminal input, a posted event or a frame due, never poll for nothing.
+    auto idle = this->event_queue.park();
+    terminal.read_events(idle ? get_time_to_frame() : std::chrono::milliseconds::zero());
+    this->event_queue.unpark();
+
+    auto input_echo = false;
+    while (auto event = this->event_queue.try_pop()) {
+      input_echo |= bool(event->id & (KEY_EVENT_MASK | EventType::PASTE));
       dispatch_event(*event);
+      if (this->quit) {
+        break;
+      }
+    }
+
+    // Everything the events just dispatched changed goes out in one frame, what typed keys changed is not held back.
+    if (this->frame_pending and input_echo) {
+      flush_immediately();
+    } else if (this->frame_pending and Clock::now() >= this->frame_due_time) {
+      print_frame();
     }
   }
 }
@@ -212,87 +288,359 @@ std::unique_ptr<Graphics> TerminalScreen::get_graphics() {
 }
 
 std::unique_ptr<Graphics> TerminalScreen::get_graphics(Rectangle const &clip) {
-  return std::make_unique<TerminalGraphics>(*this, Rectangle { 0, 0, clip.width, clip.height }, clip.x, clip.y);
+  // A window partly off the screen keeps its origin, only the part of it on the screen is drawn to.
+  return std::make_unique<TerminalGraphics>(*this, clip & Rectangle { 0, 0, get_width(), get_height() }, clip.x, clip.y);
 }
 
 void TerminalScreen::resize_view() {
   auto size = this->size;
   this->size = terminal.get_size();
   if (size != this->size) {
-    this->view.resize(this->size.height);
-    for (auto &&row : this->view) {
-      row.resize(this->size.width);
-      std::fill(row.begin(), row.end(), EMPTY_CHAR_VIEW);
-    }
+    this->view.assign(size_t(this->size.width) * this->size.height, EMPTY_CHAR_VIEW);
+    this->dirty_rows.assign(this->size.height, true);
+    invalidate_front_view();
   }
 }
 
+void TerminalScreen::invalidate_front_view() {
+  this->front_view_valid = false;
+}
+
 void TerminalScreen::terminal_resized() {
   resize_view();
   refresh();
 }
 
 void TerminalScreen::refresh() {
-  auto g = TerminalGraphics { *this };
-  paint(g);
-  flush();
+  // The windows get painted when the frame is printed, however many refreshes come before it.
+  this->refresh_pending = true;
+  request_frame();
 }
 
 TerminalColor TerminalScreen::to_terminal(Color const &c) {
-  return detail::TrueColor { c.red(), c.green(), c.blue() };
+  auto const rgb = detail::TrueColor { c.red(), c.green(), c.blue() };
+  switch (terminal.capabilities.color_depth) {
+  case Terminal::ColorDepth::PALETTE16:
+    return this->palette16_cache(rgb);
+  case Terminal::ColorDepth::PALETTE256:
+    return this->palette256_cache(rgb);
+  default:
+    // Colors that are exactly one of the palette are named by index, see detail::to_indexed_if_exact().
+    return this->true_color_cache(rgb);
+  }
 }
 
 void TerminalScreen::print() {
-  move_cursor_to(1, 1);
+  if (not this->front_view_valid) {
+    // The terminal content is unknown, erase it so that only non-empty cells need to be emitted.
+    terminal << "\x1b[2J"sv;
+    this->front_view.assign(this->view.size(), EMPTY_CHAR_VIEW);
+    this->front_view_valid = true;
+    std::fill(this->dirty_rows.begin(), this->dirty_rows.end(), true);
+    this->empty_row_hash = hash_row(this->front_view.data(), this->size.width);
+    this->front_row_hashes.assign(this->size.height, this->empty_row_hash);
+  } else {
+    scroll_moved_rows();
+  }
 
   const auto *prev_cv = &EMPTY_CHAR_VIEW;
 
   auto escape_attrs_and_colors = [&](const CharView &cv) {
-    auto reset = prev_cv->attributes & ~cv.attributes;
-    auto set = ~prev_cv->attributes & cv.attributes;
+    if (prev_cv->attributes != cv.attributes or prev_cv->foreground_color != cv.foreground_color or prev_cv->background_color != cv.background_color) {
+      escape_sgr(*prev_cv, cv);
+    }
+    prev_cv = &cv;
+  };
 
-    escape_attrs(reset, set);
+  // Cursor position, -1 if unknown.
+  auto cursor_x = -1, cursor_y = -1;
 
-    if (prev_cv->background_color != cv.background_color) {
-      escape_background_color(cv.background_color);
+  for (auto y = 0; y < this->size.height; ++y) {
+    if (not this->dirty_rows[y]) {
+      continue;
     }
+    this->dirty_rows[y] = false;
+
+    auto row = get_row(this->view, y);
+    auto front_row = get_row(this->front_view, y);
+    auto const width = this->size.width;
+
+    for (auto x = find_mismatch(row.data(), front_row.data(), 0, width); x < width; x = find_mismatch(row.data(), front_row.data(), x, width)) {
+      if (row[x].continuation and x > 0 and row[x - 1].is_wide()) {
+        x -= 1; // re-emit the whole wide glyph
+      }
+
+      auto &cv = row[x];
+      auto const cv_width = int(cv.get_width());
+      auto const wide = cv_width == 2 and x + 1 < width;
 
-    if (prev_cv->foreground_color != cv.foreground_color) {
-      escape_foreground_color(cv.foreground_color);
+      if (cursor_y != y or cursor_x > x) {
+        move_cursor_to(y + 1, x + 1);
+      } else if (cursor_x < x) {
+        move_cursor_by(0, x - cursor_x);
+      }
+
+      escape_attrs_and_colors(cv);
+      terminal << cv.get_char();
+
+      front_row[x] = cv;
+      if (wide) {
+        front_row[x + 1] = row[x + 1];
+      }
+
+      if (cv_width == 1 and terminal.capabilities.repeat_char) {
+        // Have the terminal repeat the character over the identical cells that follow when that is shorter than printing them.
+        auto end = x + 1;
+        auto changed = size_t(0);
+        for (auto i = x + 1; i < width and row[i] == cv; ++i) {
+          if (front_row[i] != cv) {
+            end = i + 1;
+            changed += 1;
+          }
+        }
+        auto const count = unsigned(end - x - 1);
+        char mb[4];
+        if (changed * util::c32_to_mb(cv.code, mb) > 3 + decimal_size(count)) {
+          terminal << "\x1b["sv << count << 'b';
+          std::fill(front_row.begin() + x + 1, front_row.begin() + end, cv);
+          x += count;
+        }
+      }
+
+      x += wide ? 2 : 1;
+      if (cv_width == 1 or cv_width == 2) {
+        cursor_x = x;
+        cursor_y = y;
+      } else {
+        cursor_y = -1;
+      }
+      if (cursor_x >= width) {
+        // With line wrap disabled the cursor sticks to the last column.
+        cursor_y = -1;
+      }
     }
 
-    prev_cv = &cv;
-  };
+    // The front row is now equal to the back one.
+    this->front_row_hashes[y] = this->row_hashes.empty() ? hash_row(row.data(), width) : this->row_hashes[y];
+  }
+  this->row_hashes.clear();
+
+  escape_attrs_and_colors(EMPTY_CHAR_VIEW);
+}
+
+/**
+ * Finds the longest block of rows that moved up or down since the last print() and has the terminal scroll it, using a scroll
+ * region (DECSTBM) and SU/SD, so that only the exposed rows are left to print. The front buffer is scrolled along.
+ */
+void TerminalScreen::scroll_moved_rows() {
+  auto const width = this->size.width, height = this->size.height;
+  if (std::count(this->dirty_rows.begin(), this->dirty_rows.end(), true) < 2) {
+    return;
+  }
+
+  this->row_hashes.resize(height);
+  for (auto y = 0; y < height; ++y) {
+    this->row_hashes[y] = this->dirty_rows[y] ? hash_row(get_row(this->view, y).data(), width) : this->front_row_hashes[y];
+  }
+
+  // Row y of the back buffer is row y + shift of the front one for `length` rows starting at `top`.
+  auto best_shift = 0, best_top = 0, best_length = 0, best_gain = 0;
+  for (auto shift = 1 - height; shift < height; ++shift) {
+    if (shift == 0) {
+      continue;
+    }
+    auto length = 0, gain = 0;
+    for (auto y = std::max(0, -shift), end = std::min(height, height - shift); y < end; ++y) {
+      if (this->row_hashes[y] != this->front_row_hashes[y + shift]) {
+        length = gain = 0;
+        continue;
+      }
+      length += 1;
+      if (this->row_hashes[y] != this->front_row_hashes[y]) {
+        gain += 1; // a row that need not be printed
+      }
+      if (gain > best_gain) {
+        best_shift = shift, best_top = y - length + 1, best_length = length, best_gain = gain;
+      }
+    }
+  }
+  if (best_gain < 2) {
+    return;
+  }
+
+  // The region spans the moved rows and the ones exposed by the move.
+  auto const lines = std::abs(best_shift);
+  auto const region_top = best_shift > 0 ? best_top : best_top - lines;
+  auto const region_bottom = region_top + best_length + lines;
 
-  for (auto y = 0U; y < this->view.size(); ++y) {
-    if (y) {
-//      escape_attrs_and_colors(EMPTY_CHAR_VIEW);
-      terminal << "\r\n"sv;
+  // Exposed rows the terminal shows right already would have to be printed again.
+  auto const exposed_top = best_shift > 0 ? region_bottom - lines : region_top;
+  for (auto y = exposed_top; y < exposed_top + lines; ++y) {
+    if (this->row_hashes[y] == this->front_row_hashes[y] && this->row_hashes[y] != this->empty_row_hash) {
+      best_gain -= 1;
     }
+  }
+  if (best_gain < 2) {
+    return;
+  }
 
-    auto skip = false;
-    for (auto &&cv : this->view[y]) {
-      if (not skip) {
-        escape_attrs_and_colors(cv);
-        terminal << cv.ch;
+  terminal << "\x1b["sv << region_top + 1 << ';' << region_bottom << 'r';
+  terminal << "\x1b["sv << lines << (best_shift > 0 ? 'S' : 'T');
+  terminal << "\x1b[r"sv; // also homes the cursor
+
+  auto region_begin = this->front_view.begin() + size_t(region_top) * width;
+  auto region_end = this->front_view.begin() + size_t(region_bottom) * width;
+  auto hashes_begin = this->front_row_hashes.begin() + region_top, hashes_end = this->front_row_hashes.begin() + region_bottom;
+  if (best_shift > 0) {
+    std::move(region_begin + size_t(lines) * width, region_end, region_begin);
+    std::fill(region_end - size_t(lines) * width, region_end, EMPTY_CHAR_VIEW);
+    std::move(hashes_begin + lines, hashes_end, hashes_begin);
+    std::fill(hashes_end - lines, hashes_end, this->empty_row_hash);
+  } else {
+    std::move_backward(region_begin, region_end - size_t(lines) * width, region_end);
+    std::fill(region_begin, region_begin + size_t(lines) * width, EMPTY_CHAR_VIEW);
+    std::move_backward(hashes_begin, hashes_end - lines, hashes_end);
+    std::fill(hashes_begin, hashes_begin + lines, this->empty_row_hash);
+  }
+  std::fill(this->dirty_rows.begin() + region_top, this->dirty_rows.begin() + region_bottom, true);
+}
+
+/**
+ * Draws ch into every cell of rect, as draw_char() would cell by cell, but with the colors converted once and a row span
+ * filled at a time.
+ */
+void TerminalScreen::fill_rect(Char ch, Rectangle const &rect, std::optional<Color> const &foreground_color, std::optional<Color> const &background_color, std::optional<Attributes> const &attributes) {
+  auto const bounds = rect & Rectangle { 0, 0, this->size.width, this->size.height };
+  if (bounds.empty()) {
+    return;
+  } else if (ch.glyph_width() != 1) {
+    for (auto y = bounds.top(); y < bounds.bottom(); ++y) {
+      for (auto x = bounds.left(); x < bounds.right(); ++x) {
+        draw_char(ch, x, y, foreground_color, background_color, attributes);
       }
-      skip = cv.is_wide();
     }
+    return;
   }
 
-  escape_attrs_and_colors(EMPTY_CHAR_VIEW);
+  auto cell = EMPTY_CHAR_VIEW;
+  cell.set_char(ch);
+  if (attributes) {
+    cell.attributes = attributes.value();
+  }
+  if (foreground_color) {
+    cell.foreground_color = to_terminal(foreground_color.value());
+  }
+  if (background_color) {
+    cell.background_color = to_terminal(background_color.value());
+  }
+  // Without a part of the style each cell keeps its own.
+  auto const complete = attributes and foreground_color and background_color;
+
+  for (auto y = bounds.top(); y < bounds.bottom(); ++y) {
+    auto row = get_row(this->view, y);
+    this->dirty_rows[y] = true;
+    break_wide_char(row, bounds.left());
+    break_wide_char(row, bounds.right() - 1);
+
+    auto span = row.subspan(bounds.left(), bounds.width);
+    if (complete) {
+      std::fill(span.begin(), span.end(), cell);
+    } else {
+      for (auto &&cv : span) {
+        cv.code = cell.code;
+        cv.width = 1;
+        cv.continuation = false;
+        if (attributes) {
+          cv.attributes = cell.attributes;
+        }
+        if (foreground_color) {
+          cv.foreground_color = cell.foreground_color;
+        }
+        if (background_color) {
+          cv.background_color = cell.background_color;
+        }
+      }
+    }
+  }
 }
 
 void TerminalScreen::clear() {
-  for (auto &line : this->view) {
-    for (auto &cell : line) {
-      cell = EMPTY_CHAR_VIEW;
+  std::fill(this->view.begin(), this->view.end(), EMPTY_CHAR_VIEW);
+  std::fill(this->dirty_rows.begin(), this->dirty_rows.end(), true);
+}
+
+void TerminalScreen::flush() {
+  request_frame();
+}
+
+void TerminalScreen::flush_immediately() {
+  if (is_event_dispatching_thread()) {
+    print_frame();
+  } else {
+    post([this] {
+      print_frame();
+    });
+  }
+}
+
+void TerminalScreen::set_max_fps(unsigned max_fps) {
+  this->frame_interval = max_fps ? std::chrono::nanoseconds(1'000'000'000 / max_fps) : std::chrono::nanoseconds::zero();
+}
+
+void TerminalScreen::request_frame() {
+  if (not is_event_dispatching_thread()) {
+    // One posted request at a time is enough, those made before it runs are folded into it.
+    if (not this->frame_request_posted.exchange(true)) {
+      post([this] {
+        this->frame_request_posted = false;
+        request_frame();
+      });
     }
+    return;
+  }
+
+  if (this->frame_pending) {
+    this->frame_stats.coalesced += 1;
+    return;
   }
+  this->frame_pending = true;
+  this->frame_due_time = std::max(this->next_frame_time, Clock::now());
 }
 
-void TerminalScreen::flush() {
+/**
+ * @return how long the event loop may sleep before the pending frame is due, forever if there is none
+ */
+std::chrono::milliseconds TerminalScreen::get_time_to_frame() const {
+  if (not this->frame_pending) {
+    return std::chrono::milliseconds::max();
+  }
+  return std::max(std::chrono::ceil<std::chrono::milliseconds>(this->frame_due_time - Clock::now()), std::chrono::milliseconds::zero());
+}
+
+void TerminalScreen::print_frame() {
+  auto const now = Clock::now();
+  if (this->frame_pending and this->frame_interval.count()) {
+    this->frame_stats.dropped += std::max(now - this->frame_due_time, Clock::duration::zero()) / this->frame_interval;
+  }
+  this->next_frame_time = now + this->frame_interval;
+  this->frame_pending = false;
+  this->frame_stats.frames += 1;
+
+  if (this->refresh_pending.exchange(false)) {
+    auto g = TerminalGraphics { *this };
+    paint(g);
+  }
+
+  // With synchronized output the terminal shows the frame once it is complete instead of rendering it as it streams in.
+  auto const synchronized = terminal.capabilities.synchronized_output
+      and (not this->front_view_valid or std::find(this->dirty_rows.begin(), this->dirty_rows.end(), true) != this->dirty_rows.end());
+  if (synchronized) {
+    terminal.set_option(Terminal::DECModeOption::SYNCHRONIZED_OUTPUT);
+  }
   print();
+  if (synchronized) {
+    terminal.reset_option(Terminal::DECModeOption::SYNCHRONIZED_OUTPUT);
+  }
   terminal.flush();
 }
 
@@ -25,6 +25,7 @@ class TerminalImpl {
   Terminal &terminal;
 
   HANDLE input_handle, output_handle;
+  HANDLE wakeup_event; // signaled by wakeup() to interrupt the wait in read_input()
   DWORD input_mode, output_mode;
   UINT input_cp, output_cp; // code pages
 
@@ -50,11 +51,19 @@ public:
     ::SetConsoleOutputCP(CP_UTF8);
     ::SetConsoleCP(CP_UTF8);
     setlocale(LC_ALL, ".utf8");
+
+    this->wakeup_event = ::CreateEvent(nullptr, FALSE, FALSE, nullptr);
+  }
+
+  void wakeup() {
+    ::SetEvent(this->wakeup_event);
   }
 
   bool read_input(const std::chrono::milliseconds &timeout, Terminal::InputBuffer &into) {
-    if (::WaitForSingleObject(this->input_handle, timeout.count()) == WAIT_TIMEOUT) {
-      return false;
+    HANDLE handles[] = { this->input_handle, this->wakeup_event };
+    auto wait_timeout = timeout == std::chrono::milliseconds::max() ? INFINITE : DWORD(timeout.count());
+    if (::WaitForMultipleObjects(DWORD(std::size(handles)), handles, FALSE, wait_timeout) != WAIT_OBJECT_0) {
+      return false; // timeout or wakeup
     }
 
     auto number_of_events = DWORD { };
@@ -67,6 +76,7 @@ public:
     this->input_records.resize(number_of_events);
 
     auto was_available = into.get_available();
+    auto resized = false;
     auto wstring = std::wstring { };
     for (auto &&record : this->input_records) {
       switch (record.EventType) {
@@ -95,19 +105,37 @@ public:
         break;
       }
       case WINDOW_BUFFER_SIZE_EVENT:
-        this->terminal.new_resize_event();
+        resized = true;
         break;
       }
     }
 
+    // A drag-resize reports every intermediate size, only the latest one is of interest.
+    if (resized) {
+      this->terminal.new_resize_event();
+    }
+
     return was_available != into.get_available();
   }
 
+  bool write_output(const char *data, size_t size) {
+    while (size > 0) {
+      auto written = DWORD { };
+      if (not ::WriteFile(this->output_handle, data, DWORD(size), &written, nullptr)) {
+        return false;
+      }
+      data += written;
+      size -= written;
+    }
+    return true;
+  }
+
   ~TerminalImpl() {
     ::SetConsoleMode(this->output_handle, this->output_mode);
     ::SetConsoleMode(this->input_handle, this->input_mode);
     ::SetConsoleOutputCP(this->output_cp);
     ::SetConsoleCP(this->input_cp);
+    ::CloseHandle(this->wakeup_event);
   }
 };
 
@@ -124,6 +152,14 @@ bool Terminal::read_input(const std::chrono::milliseconds &timeout, InputBuffer
   return this->impl->read_input(timeout, into);
 }
 
+void Terminal::wakeup() {
+  this->impl->wakeup();
+}
+
+bool Terminal::write_output(const char *data, size_t size) {
+  return this->impl->write_output(data, size);
+}
+
 static Dimension get_default_size() {
   // The terminal size in VT100 was 80x24.
   // It is still used nowadays by default in many terminal emulators.
@@ -22,6 +22,9 @@ void test_EventSource();
 void test_CharIterator();
 void test_Action();
 void test_Color();
+void test_InputParser();
+void test_BlockPool();
+void test_Window();
 
 auto make_file_menu() {
   auto file_menu = make_component<Menu>("File");
@@ -84,6 +87,9 @@ int main(int argc, char *argv[]) {
   test_CharIterator();
   test_Action();
   test_Color();
+  test_InputParser();
+  test_BlockPool();
+  test_Window();
 
   terminal.set_title("Welcome to tui++");
   terminal.flush();
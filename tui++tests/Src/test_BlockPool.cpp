@@ -0,0 +1,65 @@
+#include <tui++/util/BlockPool.h>
+
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cassert>
+
+using namespace tui::util;
+
+struct Pooled {
+  std::uint64_t value[5];
+};
+
+// Constructed before the cache of its thread, so destroyed after it, as a static that holds on to an event is.
+struct Holder {
+  std::shared_ptr<Pooled> object;
+
+  ~Holder() {
+    this->object.reset();
+    this->object = make_pooled<Pooled>(Pooled { { 42 } });
+    assert(this->object->value[0] == 42);
+  }
+};
+
+void test_BlockPool() {
+  auto a = make_pooled<Pooled>();
+  auto const *block = a.get();
+  assert(reinterpret_cast<std::uintptr_t>(block) % alignof(std::max_align_t) == 0);
+
+  // A freed block is the next one handed out.
+  a.reset();
+  auto b = make_pooled<Pooled>();
+  assert(b.get() == block);
+
+  // More blocks than a cache holds, freed by a thread that then exits and gives them back.
+  std::vector<std::shared_ptr<Pooled>> objects;
+  for (auto i = 0; i < 1000; ++i) {
+    objects.emplace_back(make_pooled<Pooled>(Pooled { { std::uint64_t(i) } }));
+  }
+  for (auto i = 0; i < 1000; ++i) {
+    assert(objects[i]->value[0] == std::uint64_t(i));
+  }
+  std::thread([&objects] {
+    objects.clear();
+  }).join();
+  for (auto i = 0; i < 1000; ++i) {
+    objects.emplace_back(make_pooled<Pooled>(Pooled { { std::uint64_t(i) } }));
+  }
+  for (auto i = 0; i < 1000; ++i) {
+    assert(objects[i]->value[0] == std::uint64_t(i));
+  }
+
+  // Blocks freed and allocated after the cache of the thread is gone go straight to and from the blocks shared by all.
+  std::thread([] {
+    thread_local Holder holder;
+    holder.object = make_pooled<Pooled>();
+  }).join();
+  objects.clear();
+  for (auto i = 0; i < 1000; ++i) {
+    objects.emplace_back(make_pooled<Pooled>(Pooled { { std::uint64_t(i) } }));
+  }
+  for (auto i = 0; i < 1000; ++i) {
+    assert(objects[i]->value[0] == std::uint64_t(i));
+  }
+}
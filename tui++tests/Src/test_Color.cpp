@@ -1,4 +1,7 @@
 #include <tui++/Color.h>
+#include <tui++/terminal/TerminalColor.h>
+
+#include <cassert>
 
 using namespace tui;
 
@@ -9,4 +12,10 @@ void test_Color() {
   static_assert(0xffff00_rgb == LIGHT_YELLOW_COLOR);
   static_assert(0xff'ff'00_rgb == LIGHT_YELLOW_COLOR);
   static_assert("#ffff00"_rgb == LIGHT_YELLOW_COLOR);
+
+  // True colors that are exactly in the 6x6x6 cube or the grayscale ramp are named by index, others as they are.
+  assert(std::get<detail::Palette256Color>(detail::to_indexed_if_exact( { 95, 135, 175 })).index == 67);
+  assert(std::get<detail::Palette256Color>(detail::to_indexed_if_exact( { 8, 8, 8 })).index == 232);
+  assert(std::holds_alternative<detail::TrueColor>(detail::to_indexed_if_exact( { 128, 0, 0 })));
+  assert(std::holds_alternative<detail::TrueColor>(detail::to_indexed_if_exact( { 96, 135, 175 })));
 }
@@ -1,3 +1,4 @@
+#include <tui++/Event.h>
 #include <tui++/event/EventSource.h>
 #include <tui++/event/MouseEvent.h>
 
@@ -143,4 +144,15 @@ void test_EventSource() {
   assert(event_source_b->get_event_listener_mask() == EventType::MOUSE_PRESS);
   assert(event_source_b->has_event_listeners(EventType::MOUSE_PRESS));
   assert(not event_source_b->has_event_listeners(EventType::WINDOW));
+
+  auto key_event = std::shared_ptr<Event> { std::make_shared<KeyEvent>(nullptr, KeyEvent::KEY_PRESSED, KeyEvent::VK_ENTER, InputEvent::NO_MODIFIERS) };
+  MouseWheelEvent mouse_wheel_event { nullptr, InputEvent::NO_MODIFIERS, 1, 2, -1 };
+  assert(event_cast<KeyEvent>(key_event) == key_event);
+  assert(event_cast<KeyEvent>(*key_event) == key_event.get());
+  assert(event_cast<MouseWheelEvent>(*key_event) == nullptr);
+  assert(event_cast<MouseWheelEvent>(mouse_wheel_event) == &mouse_wheel_event);
+  assert(event_cast<MousePressEvent>(mouse_wheel_event) == nullptr);
+  assert(event_cast<KeyEvent>(std::shared_ptr<Event> { }) == nullptr);
+  assert(mouse_wheel_event.id & COMPONENT_SOURCE_EVENT_MASK);
+  assert(not (make_event<ItemEvent>(nullptr, ItemEvent::SELECTED).id & COMPONENT_SOURCE_EVENT_MASK));
 }
@@ -0,0 +1,200 @@
+#include <tui++/terminal/InputParser.h>
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cassert>
+
+using namespace tui;
+using namespace std::string_view_literals;
+
+namespace {
+
+struct Input {
+  enum Kind {
+    CHAR,
+    KEY,
+    MOUSE,
+    WHEEL,
+    PASTE
+  } kind;
+  char32_t code;
+  InputEvent::Modifiers modifiers;
+  int x = 0, y = 0;
+  std::string text = { };
+
+  bool operator==(const Input&) const = default;
+};
+
+class InputRecorder: public InputParser::Listener {
+public:
+  std::vector<Input> inputs;
+
+  void new_key_event(const Char &c, InputEvent::Modifiers key_modifiers) override {
+    this->inputs.emplace_back(Input::CHAR, c.get_code(), key_modifiers);
+  }
+
+  void new_key_event(KeyEvent::KeyCode key_code, InputEvent::Modifiers key_modifiers) override {
+    this->inputs.emplace_back(Input::KEY, key_code, key_modifiers);
+  }
+
+  void new_mouse_event(MousePressEvent::Type type, MousePressEvent::Button button, InputEvent::Modifiers key_modifiers, int x, int y) override {
+    this->inputs.emplace_back(Input::MOUSE, char32_t(type == MousePressEvent::MOUSE_PRESSED ? button : button + 4), key_modifiers, x, y);
+  }
+
+  void new_mouse_wheel_event(int wheel_rotation, InputEvent::Modifiers key_modifiers, int x, int y) override {
+    this->inputs.emplace_back(Input::WHEEL, char32_t(wheel_rotation + 1), key_modifiers, x, y);
+  }
+
+  void new_paste_event(std::string_view text) override {
+    this->inputs.emplace_back(Input::PASTE, 0, InputEvent::NO_MODIFIERS, 0, 0, std::string(text));
+  }
+};
+
+// What xterm sends for a short session: typing, cursor and function keys, the mouse, late replies to queries and a paste.
+// parse() expects the two string replies in it.
+constexpr auto captured_input = "Hello, \xd0\xbc\xd0\xb8\xd1\x80 \xf0\x9f\x98\x80\r"
+    "\x1b[A\x1b[1;5C\x1bOP\x1b[3~\x1b[15;2~\x1b[Z"
+    "\x1b[<0;10;5M\x1b[<0;10;5m\x1b[<35;11;5M\x1b[<64;3;4M\x1b[<65;3;4M"
+    "\x1b[?2026;2$y\x1b[?0u\x1bP1+r524742\x1b\\\x1b]11;rgb:0000/0000/0000\x07\x1b[?62;22c"
+    "\x1b[200~pasted \x1b[A text\r\x1b[201~"
+    "\x1bx\x1b\x1b[B\x01\x7f\t\x1b"sv;
+
+std::vector<Input> parse(std::string_view input, const std::vector<size_t> &splits, unsigned string_replies = 2) {
+  InputRecorder recorder;
+  InputParser parser { recorder };
+  for (auto i = 0U; i < string_replies; ++i) {
+    parser.expect_string_reply();
+  }
+  // What the parser leaves unconsumed is passed again with the next chunk, as Terminal does with its input buffer.
+  std::string buffer;
+  size_t from = 0;
+  for (auto split : splits) {
+    buffer.append(input.substr(from, split - from));
+    buffer.erase(0, parser.parse(buffer));
+    from = split;
+  }
+  buffer.append(input.substr(from));
+  buffer.erase(0, parser.parse(buffer));
+  buffer.erase(0, parser.flush(buffer));
+  return recorder.inputs;
+}
+
+}
+
+void test_InputParser() {
+  auto const inputs = parse(captured_input, { });
+
+  auto const expected = std::vector<Input> {
+    { Input::CHAR, 'H', InputEvent::NO_MODIFIERS },
+    { Input::CHAR, 'e', InputEvent::NO_MODIFIERS },
+    { Input::CHAR, 'l', InputEvent::NO_MODIFIERS },
+    { Input::CHAR, 'l', InputEvent::NO_MODIFIERS },
+    { Input::CHAR, 'o', InputEvent::NO_MODIFIERS },
+    { Input::CHAR, ',', InputEvent::NO_MODIFIERS },
+    { Input::KEY, KeyEvent::VK_SPACE, InputEvent::NO_MODIFIERS },
+    { Input::CHAR, U'м', InputEvent::NO_MODIFIERS },
+    { Input::CHAR, U'и', InputEvent::NO_MODIFIERS },
+    { Input::CHAR, U'р', InputEvent::NO_MODIFIERS },
+    { Input::KEY, KeyEvent::VK_SPACE, InputEvent::NO_MODIFIERS },
+    { Input::CHAR, U'\U0001F600', InputEvent::NO_MODIFIERS },
+    { Input::KEY, KeyEvent::VK_ENTER, InputEvent::NO_MODIFIERS },
+    { Input::KEY, KeyEvent::VK_UP, InputEvent::NO_MODIFIERS },
+    { Input::KEY, KeyEvent::VK_RIGHT, InputEvent::CTRL_DOWN },
+    { Input::KEY, KeyEvent::VK_F1, InputEvent::NO_MODIFIERS },
+    { Input::KEY, KeyEvent::VK_DELETE, InputEvent::NO_MODIFIERS },
+    { Input::KEY, KeyEvent::VK_F5, InputEvent::SHIFT_DOWN },
+    { Input::KEY, KeyEvent::VK_BACK_TAB, InputEvent::NO_MODIFIERS },
+    { Input::MOUSE, MousePressEvent::LEFT_BUTTON, InputEvent::NO_MODIFIERS, 9, 4 },
+    { Input::MOUSE, MousePressEvent::LEFT_BUTTON + 4, InputEvent::NO_MODIFIERS, 9, 4 },
+    { Input::MOUSE, MousePressEvent::NO_BUTTON, InputEvent::NO_MODIFIERS, 10, 4 },
+    { Input::WHEEL, 0, InputEvent::NO_MODIFIERS, 2, 3 },
+    { Input::WHEEL, 2, InputEvent::NO_MODIFIERS, 2, 3 },
+    { Input::PASTE, 0, InputEvent::NO_MODIFIERS, 0, 0, "pasted \x1b[A text\r" },
+    { Input::KEY, KeyEvent::KeyCode('x'), InputEvent::ALT_DOWN },
+    { Input::KEY, KeyEvent::VK_ESCAPE, InputEvent::NO_MODIFIERS },
+    { Input::KEY, KeyEvent::VK_DOWN, InputEvent::NO_MODIFIERS },
+    { Input::KEY, KeyEvent::VK_A, InputEvent::CTRL_DOWN },
+    { Input::KEY, KeyEvent::VK_BACK_SPACE, InputEvent::NO_MODIFIERS },
+    { Input::KEY, KeyEvent::VK_TAB, InputEvent::NO_MODIFIERS },
+    { Input::KEY, KeyEvent::VK_ESCAPE, InputEvent::NO_MODIFIERS },
+  };
+  assert(inputs == expected);
+
+  // Replay split at every byte, and a byte at a time, the sequences must resume across the chunks.
+  for (size_t split = 1; split < captured_input.size(); ++split) {
+    assert(parse(captured_input, { split }) == expected);
+  }
+
+  std::vector<size_t> every_byte(captured_input.size() - 1);
+  for (size_t i = 0; i < every_byte.size(); ++i) {
+    every_byte[i] = i + 1;
+  }
+  assert(parse(captured_input, every_byte) == expected);
+
+  // Fuzz, random chunks of the capture spliced with random bytes parse the same however they are cut.
+  std::mt19937 random { 2026 };
+  for (auto round = 0; round < 200; ++round) {
+    std::string input;
+    while (input.size() < 512) {
+      if (random() % 2) {
+        auto const from = random() % captured_input.size();
+        input += captured_input.substr(from, random() % 32);
+      } else {
+        for (auto n = random() % 8; n > 0; --n) {
+          input += char(random());
+        }
+      }
+    }
+
+    std::vector<size_t> splits;
+    for (size_t split = random() % 16; split < input.size(); split += 1 + random() % 16) {
+      splits.emplace_back(split);
+    }
+    assert(parse(input, splits) == parse(input, { }));
+  }
+
+  // Unless a reply is expected, ESC P is Alt+P rather than the start of a DCS string that would swallow the keys after it.
+  auto const alt_p = std::vector<Input> {
+    { Input::KEY, KeyEvent::KeyCode('P'), InputEvent::ALT_DOWN },
+    { Input::CHAR, 'a', InputEvent::NO_MODIFIERS },
+    { Input::CHAR, 'b', InputEvent::NO_MODIFIERS },
+    { Input::CHAR, 'c', InputEvent::NO_MODIFIERS },
+  };
+  assert(parse("\x1b" "P" "abc"sv, { }, 0) == alt_p);
+  assert(parse("\x1b" "P" "abc"sv, { 1 }, 0) == alt_p);
+  assert(parse("\x1b" "]" "abc"sv, { }, 0).size() == 4);
+  assert(parse("\x1b[?62;22c\x1b" "P" "abc"sv, { }, 1) == alt_p);
+
+  // A paste whose end never comes is given up on, as Terminal does once it times out, and the keys after it are keys.
+  InputRecorder recorder;
+  InputParser parser { recorder };
+  std::string buffer = "\x1b[200~pasted";
+  buffer.erase(0, parser.parse(buffer));
+  assert(parser.is_paste_pending() and recorder.inputs.empty());
+  buffer.erase(0, parser.flush(buffer));
+  buffer += "ab";
+  buffer.erase(0, parser.parse(buffer));
+  assert(buffer.empty());
+  assert((recorder.inputs == std::vector<Input> {
+    { Input::PASTE, 0, InputEvent::NO_MODIFIERS, 0, 0, "pasted" },
+    { Input::CHAR, 'a', InputEvent::NO_MODIFIERS },
+    { Input::CHAR, 'b', InputEvent::NO_MODIFIERS },
+  }));
+
+  // Nor is an endless one held on to past MAX_PASTE_SIZE, it is reported in parts, short of an end that came in part.
+  recorder.inputs.clear();
+  buffer = "\x1b[200~" + std::string(InputParser::MAX_PASTE_SIZE, 'a') + "\x1b[20";
+  buffer.erase(0, parser.parse(buffer));
+  assert(buffer == "a\x1b[20" and recorder.inputs.size() == 1);
+  assert(recorder.inputs[0].text == std::string(InputParser::MAX_PASTE_SIZE - 1, 'a'));
+  buffer += "1~ab";
+  buffer.erase(0, parser.parse(buffer));
+  assert(buffer.empty());
+  assert((recorder.inputs == std::vector<Input> {
+    recorder.inputs[0],
+    { Input::PASTE, 0, InputEvent::NO_MODIFIERS, 0, 0, "a" },
+    { Input::CHAR, 'a', InputEvent::NO_MODIFIERS },
+    { Input::CHAR, 'b', InputEvent::NO_MODIFIERS },
+  }));
+}
@@ -0,0 +1,32 @@
+#include <tui++/Window.h>
+#include <tui++/Graphics.h>
+
+#include <cassert>
+
+using namespace tui;
+
+class PaintedWindow: public Window {
+public:
+  Rectangle painted_clip;
+
+  PaintedWindow() = default;
+
+  using Window::init;
+
+  void paint(Graphics &g) override {
+    this->painted_clip = g.get_clip_rect();
+  }
+};
+
+void test_Window() {
+  // Kept, the events posted on showing and hiding it are dispatched by the event loop.
+  static auto window = make_component<PaintedWindow>();
+  window->set_bounds(10, 5, 20, 6);
+  window->set_visible(true);
+
+  // A window paints in the coordinates of the screen, whatever its location.
+  window->paint_immediately(1, 1, 3, 2);
+  assert((window->painted_clip == Rectangle { 11, 6, 3, 2 }));
+
+  window->set_visible(false);
+}
@@ -25,4 +25,21 @@ void test_utf8() {
   // Control characters:
   static_assert(glyph_width("\1"s) == 0);
   static_assert(glyph_width("a\1a"s) == 2);
+
+  // Word break properties:
+  static_assert(unicode::word_break_map[U'a'] == unicode::WordBreak::ALetter);
+  static_assert(unicode::word_break_map[U'7'] == unicode::WordBreak::Numeric);
+  static_assert(unicode::word_break_map[U'\u30A2'] == unicode::WordBreak::Katakana);
+  static_assert(unicode::word_break_map[0xE0100] == unicode::WordBreak::Extend);
+  static_assert(unicode::word_break_map[0x10FFFF] == unicode::WordBreak::None);
+  static_assert(unicode::word_break_map[0x200000] == unicode::WordBreak::None);
+
+  // Code point widths:
+  static_assert(unicode::glyph_width(U'a') == 1);
+  static_assert(unicode::glyph_width(U'\n') == 1);
+  static_assert(unicode::glyph_width(U'\x1b') == -1);
+  static_assert(unicode::glyph_width(U'\u0301') == 0);
+  static_assert(unicode::glyph_width(U'\u3099') == 0); // both combining and full width
+  static_assert(unicode::glyph_width(U'\u6D4B') == 2);
+  static_assert(unicode::glyph_width(0x3FFFE) == 1);
 }